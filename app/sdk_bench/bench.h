@@ -0,0 +1,85 @@
+/*
+ *  SLAMTEC LIDAR
+ *  SDK Micro Benchmarks
+ *
+ *  Copyright (c) 2014 - 2023 Shanghai Slamtec Co., Ltd.
+ *  http://www.slamtec.com
+ *
+ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stddef.h>
+#include <chrono>
+#include <vector>
+#include <string>
+
+// every benchmark returns 0 on success, argv holds the arguments after the benchmark name
+typedef int (*bench_proc_t)(int argc, const char* argv[]);
+
+int bench_codec(int argc, const char* argv[]);
+int bench_crc(int argc, const char* argv[]);
+int bench_scan_sort(int argc, const char* argv[]);
+int bench_geometry(int argc, const char* argv[]);
+int bench_serial_latency(int argc, const char* argv[]);
+
+// best time of several rounds, in nanoseconds per item
+template <class T>
+double bench_measure(T&& proc, size_t itemsPerRound, int rounds = 5)
+{
+    double best = 0;
+    for (int round = 0; round < rounds; ++round) {
+        auto start = std::chrono::steady_clock::now();
+        proc();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / (double)itemsPerRound;
+        if (!round || ns < best) best = ns;
+    }
+    return best;
+}
+
+// unit is printed after the value, e.g. "ns/msg"
+static inline void bench_report(const char* label, double value, const char* unit, double baseline = 0)
+{
+    if (baseline > 0) {
+        printf("  %-40s %10.2f %s  (x%.2f)\n", label, value, unit, baseline / value);
+    }
+    else {
+        printf("  %-40s %10.2f %s\n", label, value, unit);
+    }
+}
+
+// reads a whole file, used to replay raw data captured from a device
+static inline bool bench_load_file(const char* path, std::vector<unsigned char>& data)
+{
+    FILE* fp = fopen(path, "rb");
+    if (!fp) return false;
+
+    unsigned char buffer[4096];
+    size_t size;
+    data.clear();
+    while ((size = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+        data.insert(data.end(), buffer, buffer + size);
+    }
+    fclose(fp);
+    return true;
+}
+
+// prevents the compiler from optimizing away the benchmarked results
+extern volatile size_t bench_sink;
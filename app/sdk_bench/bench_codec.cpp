@@ -0,0 +1,219 @@
+/*
+ *  SLAMTEC LIDAR
+ *  SDK Micro Benchmarks
+ *
+ *  Copyright (c) 2014 - 2023 Shanghai Slamtec Co., Ltd.
+ *  http://www.slamtec.com
+ *
+ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "sdkcommon.h"
+#include "hal/locker.h"
+#include "hal/event.h"
+#include "hal/thread.h"
+#include "sl_lidar_driver.h"
+#include "sl_lidarprotocol_codec.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+
+using namespace sl::internal;
+
+namespace {
+
+// the per-byte state machine the codec used before the payload was copied in bulk,
+// kept here as the baseline
+class PerByteDecoder
+{
+public:
+    PerByteDecoder(IProtocolMessageListener& listener)
+        : _listener(listener)
+        , _state(RPLidarProtocolCodec::STATUS_WAIT_SYNC1)
+        , _loopMode(false)
+        , _rxPos(0)
+    {
+    }
+
+    void onDecodeData(const _u8* data, size_t size)
+    {
+        for (size_t pos = 0; pos < size; ++pos) {
+            _u8 currentByte = data[pos];
+            switch (_state) {
+            case RPLidarProtocolCodec::STATUS_WAIT_SYNC1:
+                if (currentByte == SL_LIDAR_ANS_SYNC_BYTE1) _state = RPLidarProtocolCodec::STATUS_WAIT_SYNC2;
+                break;
+            case RPLidarProtocolCodec::STATUS_WAIT_SYNC2:
+                _state = (currentByte == SL_LIDAR_ANS_SYNC_BYTE2) ? RPLidarProtocolCodec::STATUS_WAIT_SIZE_FLAG : RPLidarProtocolCodec::STATUS_WAIT_SYNC1;
+                _rxPos = 0;
+                _sizeFlag = 0;
+                break;
+            case RPLidarProtocolCodec::STATUS_WAIT_SIZE_FLAG:
+                _sizeFlag |= (_u32)currentByte << (8 * _rxPos);
+                if (++_rxPos == 4) {
+                    _loopMode = ((_sizeFlag >> SL_LIDAR_ANS_HEADER_SUBTYPE_SHIFT) & SL_LIDAR_ANS_PKTFLAG_LOOP) != 0;
+                    _message.fillData(NULL, _sizeFlag & SL_LIDAR_ANS_HEADER_SIZE_MASK);
+                    _state = RPLidarProtocolCodec::STATUS_WAIT_TYPE;
+                    _rxPos = 0;
+                }
+                break;
+            case RPLidarProtocolCodec::STATUS_WAIT_TYPE:
+                _message.cmd = currentByte;
+                _state = _message.getPayloadSize() ? RPLidarProtocolCodec::STATUS_RECV_PAYLOAD : RPLidarProtocolCodec::STATUS_WAIT_SYNC1;
+                break;
+            case RPLidarProtocolCodec::STATUS_RECV_PAYLOAD:
+                _message.getDataBuf()[_rxPos++] = currentByte;
+                if ((size_t)_rxPos == _message.getPayloadSize()) {
+                    _rxPos = 0;
+                    if (!_loopMode) _state = RPLidarProtocolCodec::STATUS_WAIT_SYNC1;
+                    _listener.onProtocolMessageDecoded(_message);
+                }
+                break;
+            }
+        }
+    }
+
+protected:
+    IProtocolMessageListener& _listener;
+    ProtocolMessage _message;
+    _u32 _state;
+    bool _loopMode;
+    int  _rxPos;
+    _u32 _sizeFlag;
+};
+
+class CountingListener : public IProtocolMessageListener
+{
+public:
+    CountingListener(bool consumeInPlace)
+        : count(0)
+        , checksum(0)
+        , _consumeInPlace(consumeInPlace)
+    {
+    }
+
+    virtual void onProtocolMessageDecoded(const ProtocolMessage& msg)
+    {
+        _onPayload(msg.getDataBuf(), msg.getPayloadSize());
+    }
+
+    virtual bool onLoopModePayloadDecoded(_u8 type, const _u8* payload, size_t size)
+    {
+        if (!_consumeInPlace) return false;
+        _onPayload(payload, size);
+        return true;
+    }
+
+    size_t count;
+    size_t checksum;
+
+protected:
+    void _onPayload(const _u8* payload, size_t size)
+    {
+        ++count;
+        checksum += payload[0] + payload[size - 1];
+    }
+
+    bool _consumeInPlace;
+};
+
+// a loop-mode answer header followed by count dense capsules of random content
+void generateCapsuleStream(std::vector<_u8>& stream, size_t count)
+{
+    const _u32 payloadSize = sizeof(sl_lidar_response_dense_capsule_measurement_nodes_t);
+    const _u32 sizeFlag = payloadSize | ((_u32)SL_LIDAR_ANS_PKTFLAG_LOOP << SL_LIDAR_ANS_HEADER_SUBTYPE_SHIFT);
+
+    stream.clear();
+    stream.push_back(SL_LIDAR_ANS_SYNC_BYTE1);
+    stream.push_back(SL_LIDAR_ANS_SYNC_BYTE2);
+    for (int pos = 0; pos < 4; ++pos) {
+        stream.push_back((_u8)(sizeFlag >> (8 * pos)));
+    }
+    stream.push_back(SL_LIDAR_ANS_TYPE_MEASUREMENT_DENSE_CAPSULED);
+
+    srand(1);
+    for (size_t pos = 0; pos < count * payloadSize; ++pos) {
+        stream.push_back((_u8)rand());
+    }
+}
+
+}
+
+int bench_codec(int argc, const char* argv[])
+{
+    std::vector<_u8> stream;
+    if (argc > 0) {
+        if (!bench_load_file(argv[0], stream)) {
+            fprintf(stderr, "cannot read %s\n", argv[0]);
+            return -1;
+        }
+    }
+    else {
+        generateCapsuleStream(stream, 20000);
+    }
+
+    // the number of messages decoded from the stream is the unit of the results
+    size_t messageCount;
+    {
+        CountingListener listener(false);
+        PerByteDecoder decoder(listener);
+        decoder.onDecodeData(&stream[0], stream.size());
+        messageCount = listener.count;
+    }
+    if (!messageCount) {
+        fprintf(stderr, "no message found in the stream\n");
+        return -1;
+    }
+    printf("  %zu bytes, %zu messages\n", stream.size(), messageCount);
+
+    static const size_t chunkSizes[] = { 32, 256, 4096 };
+    int ans = 0;
+    for (size_t sizePos = 0; sizePos < sizeof(chunkSizes) / sizeof(chunkSizes[0]); ++sizePos) {
+        const size_t chunkSize = chunkSizes[sizePos];
+        printf(" chunk size %zu\n", chunkSize);
+
+        CountingListener refListener(false);
+        double perByteNs = bench_measure([&]() {
+            PerByteDecoder decoder(refListener);
+            for (size_t pos = 0; pos < stream.size(); pos += chunkSize) {
+                decoder.onDecodeData(&stream[pos], std::min(chunkSize, stream.size() - pos));
+            }
+        }, messageCount);
+        bench_report("per-byte state machine (baseline)", perByteNs, "ns/msg");
+
+        for (int inPlace = 0; inPlace < 2; ++inPlace) {
+            CountingListener listener(inPlace != 0);
+            double codecNs = bench_measure([&]() {
+                RPLidarProtocolCodec codec;
+                codec.setMessageListener(&listener);
+                for (size_t pos = 0; pos < stream.size(); pos += chunkSize) {
+                    codec.onDecodeData(&stream[pos], std::min(chunkSize, stream.size() - pos));
+                }
+            }, messageCount);
+            bench_report(inPlace ? "RPLidarProtocolCodec, in place" : "RPLidarProtocolCodec, bulk copy", codecNs, "ns/msg", perByteNs);
+
+            if (listener.checksum != refListener.checksum) {
+                fprintf(stderr, "decoded payloads differ from the baseline\n");
+                ans = -1;
+            }
+        }
+        bench_sink += refListener.checksum;
+    }
+    return ans;
+}
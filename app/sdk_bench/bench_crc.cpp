@@ -0,0 +1,86 @@
+/*
+ *  SLAMTEC LIDAR
+ *  SDK Micro Benchmarks
+ *
+ *  Copyright (c) 2014 - 2023 Shanghai Slamtec Co., Ltd.
+ *  http://www.slamtec.com
+ *
+ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "sl_lidar_driver.h"
+#include "sl_crc.h"
+#include "sl_crc_internal.h"
+
+#include <stdlib.h>
+
+#include "bench.h"
+
+using namespace sl::crc32::internal;
+
+int bench_crc(int argc, const char* argv[])
+{
+    // an HQ capsule is 777 bytes, the other sizes show the small and large buffer behavior
+    static const size_t lengths[] = { 16, 84, 777, 4096 };
+    const int iterations = 20000;
+
+    CrcUpdateVariant variants[8];
+    size_t variantCount = getUpdateVariants(variants, sizeof(variants) / sizeof(variants[0]));
+
+    std::vector<sl_u8> buffer(4096);
+    srand(1);
+    for (size_t pos = 0; pos < buffer.size(); ++pos) {
+        buffer[pos] = (sl_u8)rand();
+    }
+
+    int ans = 0;
+    for (size_t lenPos = 0; lenPos < sizeof(lengths) / sizeof(lengths[0]); ++lenPos) {
+        const size_t len = lengths[lenPos];
+        printf(" %zu bytes\n", len);
+
+        const sl_u32 expected = variants[0].update(0xFFFFFFFF, &buffer[0], len);
+        double baselineNs = 0;
+        for (size_t pos = 0; pos < variantCount; ++pos) {
+            crc_update_proc_t update = variants[pos].update;
+            if (update(0xFFFFFFFF, &buffer[0], len) != expected) {
+                fprintf(stderr, "%s does not match the byte-wise result\n", variants[pos].name);
+                ans = -1;
+            }
+
+            double ns = bench_measure([&]() {
+                sl_u32 crc = 0;
+                for (int it = 0; it < iterations; ++it) {
+                    crc = update(crc, &buffer[0], len);
+                }
+                bench_sink += crc;
+            }, iterations);
+            if (!pos) baselineNs = ns;
+            bench_report(variants[pos].name, ns, "ns/buffer", pos ? baselineNs : 0);
+        }
+
+        // the public entry point, including the padding and the dispatch
+        double ns = bench_measure([&]() {
+            sl_u32 crc = 0;
+            for (int it = 0; it < iterations; ++it) {
+                crc += sl::crc32::getResult(&buffer[0], (sl_u32)len);
+            }
+            bench_sink += crc;
+        }, iterations);
+        bench_report("crc32::getResult()", ns, "ns/buffer", baselineNs);
+    }
+    return ans;
+}
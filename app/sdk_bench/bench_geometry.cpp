@@ -0,0 +1,92 @@
+/*
+ *  SLAMTEC LIDAR
+ *  SDK Micro Benchmarks
+ *
+ *  Copyright (c) 2014 - 2023 Shanghai Slamtec Co., Ltd.
+ *  http://www.slamtec.com
+ *
+ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "sl_lidar_driver.h"
+#include "sl_lidar_geometry.h"
+#include "sl_lidar_geometry_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+
+using namespace sl::geometry;
+
+int bench_geometry(int argc, const char* argv[])
+{
+    // 800 nodes is a revolution of the A-series, 8000 one of the S-series in the densest mode
+    static const size_t counts[] = { 800, 8000 };
+    const int iterations = 200;
+
+    internal::ConvertVariant variants[8];
+    size_t variantCount = internal::getConvertVariants(variants, sizeof(variants) / sizeof(variants[0]));
+
+    std::vector<sl_lidar_response_measurement_node_hq_t> nodes(8000);
+    srand(1);
+    for (size_t pos = 0; pos < nodes.size(); ++pos) {
+        nodes[pos].angle_z_q14 = (sl_u16)rand();
+        nodes[pos].dist_mm_q2 = (sl_u32)(rand() % 100000);
+        nodes[pos].quality = (sl_u8)rand();
+        nodes[pos].flag = 0;
+    }
+    std::vector<float> refX(nodes.size()), refY(nodes.size()), refIntensity(nodes.size());
+    std::vector<float> x(nodes.size()), y(nodes.size()), intensity(nodes.size());
+
+    int ans = 0;
+    for (size_t countPos = 0; countPos < sizeof(counts) / sizeof(counts[0]); ++countPos) {
+        const size_t count = counts[countPos];
+        printf(" %zu nodes\n", count);
+
+        polarToCartesianScalar(&nodes[0], count, &refX[0], &refY[0], &refIntensity[0]);
+        double baselineNs = 0;
+        for (size_t pos = 0; pos < variantCount; ++pos) {
+            internal::convert_proc_t convert = variants[pos].convert;
+            convert(&nodes[0], count, &x[0], &y[0], &intensity[0]);
+            if (memcmp(&x[0], &refX[0], count * sizeof(float)) || memcmp(&y[0], &refY[0], count * sizeof(float))
+                || memcmp(&intensity[0], &refIntensity[0], count * sizeof(float))) {
+                fprintf(stderr, "%s does not match the scalar result\n", variants[pos].name);
+                ans = -1;
+            }
+
+            double ns = bench_measure([&]() {
+                for (int it = 0; it < iterations; ++it) {
+                    convert(&nodes[0], count, &x[0], &y[0], &intensity[0]);
+                }
+                bench_sink += (size_t)x[count - 1];
+            }, iterations * count);
+            if (!pos) baselineNs = ns;
+            bench_report(variants[pos].name, ns, "ns/node", pos ? baselineNs : 0);
+        }
+
+        // the public entry point, including the dispatch
+        double ns = bench_measure([&]() {
+            for (int it = 0; it < iterations; ++it) {
+                polarToCartesian(&nodes[0], count, &x[0], &y[0], &intensity[0]);
+            }
+            bench_sink += (size_t)x[count - 1];
+        }, iterations * count);
+        bench_report("geometry::polarToCartesian()", ns, "ns/node", baselineNs);
+    }
+    return ans;
+}
@@ -0,0 +1,181 @@
+/*
+ *  SLAMTEC LIDAR
+ *  SDK Micro Benchmarks
+ *
+ *  Copyright (c) 2014 - 2023 Shanghai Slamtec Co., Ltd.
+ *  http://www.slamtec.com
+ *
+ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "sl_lidar_driver.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#include "bench.h"
+
+using namespace sl;
+
+namespace {
+
+// ascendScanData() as it was before the fixed-point rewrite, kept here as the baseline
+inline float getAngle(const sl_lidar_response_measurement_node_hq_t& node)
+{
+    return node.angle_z_q14 * 90.f / 16384.f;
+}
+
+inline void setAngle(sl_lidar_response_measurement_node_hq_t& node, float v)
+{
+    node.angle_z_q14 = sl_u32(v * 16384.f / 90.f);
+}
+
+bool angleLessThan(const sl_lidar_response_measurement_node_hq_t& a, const sl_lidar_response_measurement_node_hq_t& b)
+{
+    return getAngle(a) < getAngle(b);
+}
+
+sl_result ascendScanDataFloat(sl_lidar_response_measurement_node_hq_t* nodebuffer, size_t count)
+{
+    float inc_origin_angle = 360.f / count;
+    size_t i = 0;
+
+    for (i = 0; i < count; i++) {
+        if (nodebuffer[i].dist_mm_q2 == 0) continue;
+        while (i != 0) {
+            i--;
+            float expect_angle = getAngle(nodebuffer[i + 1]) - inc_origin_angle;
+            if (expect_angle < 0.0f) expect_angle = 0.0f;
+            setAngle(nodebuffer[i], expect_angle);
+        }
+        break;
+    }
+    if (i == count) return SL_RESULT_OPERATION_FAIL;
+
+    for (i = count - 1; i < count; i--) {
+        if (nodebuffer[i].dist_mm_q2 == 0) continue;
+        while (i != (count - 1)) {
+            i++;
+            float expect_angle = getAngle(nodebuffer[i - 1]) + inc_origin_angle;
+            if (expect_angle > 360.0f) expect_angle -= 360.0f;
+            setAngle(nodebuffer[i], expect_angle);
+        }
+        break;
+    }
+
+    float frontAngle = getAngle(nodebuffer[0]);
+    for (i = 1; i < count; i++) {
+        if (nodebuffer[i].dist_mm_q2 == 0) {
+            float expect_angle = frontAngle + i * inc_origin_angle;
+            if (expect_angle > 360.0f) expect_angle -= 360.0f;
+            setAngle(nodebuffer[i], expect_angle);
+        }
+    }
+
+    std::sort(nodebuffer, nodebuffer + count, &angleLessThan);
+    return SL_RESULT_OK;
+}
+
+// one revolution as delivered by the device: ascending angles starting anywhere on the circle,
+// small jitter between neighbours and some samples without a valid distance
+void generateRevolution(std::vector<sl_lidar_response_measurement_node_hq_t>& nodes, size_t count)
+{
+    nodes.resize(count);
+    const sl_u32 fullCircle = 4 << 14;
+    sl_u32 startAngle = (sl_u32)rand() % fullCircle;
+
+    for (size_t pos = 0; pos < count; ++pos) {
+        sl_s32 jitter = (rand() % 5) - 2;
+        sl_s32 angle = (sl_s32)(startAngle + (sl_u32)(((sl_u64)pos * fullCircle) / count)) + jitter;
+        angle = (angle + (sl_s32)fullCircle) % (sl_s32)fullCircle;
+
+        nodes[pos].angle_z_q14 = (sl_u16)angle;
+        nodes[pos].dist_mm_q2 = (rand() % 10) ? (sl_u32)(1000 + rand() % 40000) : 0;
+        nodes[pos].quality = (sl_u8)rand();
+        nodes[pos].flag = 0;
+    }
+}
+
+}
+
+int bench_scan_sort(int argc, const char* argv[])
+{
+    static const size_t pointCounts[] = { 2000, 8000, 32000 };
+    const int revolutions = 50;
+
+    Result<ILidarDriver*> driver = createLidarDriver();
+    if (!driver) return -1;
+
+    int ans = 0;
+    for (size_t countPos = 0; countPos < sizeof(pointCounts) / sizeof(pointCounts[0]); ++countPos) {
+        const size_t count = pointCounts[countPos];
+        printf(" %zu points per revolution\n", count);
+
+        srand(1);
+        std::vector<std::vector<sl_lidar_response_measurement_node_hq_t> > inputs(revolutions);
+        for (int rev = 0; rev < revolutions; ++rev) {
+            generateRevolution(inputs[rev], count);
+        }
+
+        std::vector<sl_lidar_response_measurement_node_hq_t> work(count), expected(count);
+
+        // both sides include the copy of the input
+        double copyNs = bench_measure([&]() {
+            for (int rev = 0; rev < revolutions; ++rev) {
+                memcpy(&work[0], &inputs[rev][0], count * sizeof(work[0]));
+                bench_sink += work[count / 2].angle_z_q14;
+            }
+        }, revolutions);
+
+        double floatNs = bench_measure([&]() {
+            for (int rev = 0; rev < revolutions; ++rev) {
+                memcpy(&work[0], &inputs[rev][0], count * sizeof(work[0]));
+                ascendScanDataFloat(&work[0], count);
+                bench_sink += work[count / 2].angle_z_q14;
+            }
+        }, revolutions) - copyNs;
+        bench_report("float + std::sort (baseline)", floatNs / 1000, "us/rev");
+
+        double fixedNs = bench_measure([&]() {
+            for (int rev = 0; rev < revolutions; ++rev) {
+                memcpy(&work[0], &inputs[rev][0], count * sizeof(work[0]));
+                (*driver)->ascendScanData(&work[0], count);
+                bench_sink += work[count / 2].angle_z_q14;
+            }
+        }, revolutions) - copyNs;
+        bench_report("ILidarDriver::ascendScanData()", fixedNs / 1000, "us/rev", floatNs / 1000);
+
+        // the fixed-point angles may differ from the float ones by one q14 unit
+        int maxDiff = 0;
+        for (int rev = 0; rev < revolutions; ++rev) {
+            expected = inputs[rev];
+            work = inputs[rev];
+            ascendScanDataFloat(&expected[0], count);
+            (*driver)->ascendScanData(&work[0], count);
+            for (size_t pos = 0; pos < count; ++pos) {
+                int diff = abs((int)work[pos].angle_z_q14 - (int)expected[pos].angle_z_q14);
+                if (diff > maxDiff) maxDiff = diff;
+            }
+        }
+        printf("  max angle difference: %d q14 units\n", maxDiff);
+        if (maxDiff > 1) ans = -1;
+    }
+
+    delete *driver;
+    return ans;
+}
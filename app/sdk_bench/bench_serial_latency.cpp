@@ -0,0 +1,158 @@
+/*
+ *  SLAMTEC LIDAR
+ *  SDK Micro Benchmarks
+ *
+ *  Copyright (c) 2014 - 2023 Shanghai Slamtec Co., Ltd.
+ *  http://www.slamtec.com
+ *
+ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "sl_lidar_driver.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#include "bench.h"
+
+#ifdef __linux__
+
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <thread>
+
+using namespace sl;
+
+namespace {
+
+const size_t CAPSULE_SIZE = 132;
+
+long long nowUs()
+{
+    return (long long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Writes a capsule every millisecond to the master side of a pty and measures when the
+// channel opened on the slave side returns its last byte from waitAndRead().
+int measureLatency(const char* label, const SerialPortChannelOptions& options, size_t capsuleCount)
+{
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) || unlockpt(master)) {
+        fprintf(stderr, "cannot create a pty pair\n");
+        if (master >= 0) close(master);
+        return -1;
+    }
+    termios tio;
+    tcgetattr(master, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(master, TCSANOW, &tio);
+
+    IChannel* channel = *createSerialPortChannel(ptsname(master), 1000000, options);
+    if (!channel || !channel->open()) {
+        fprintf(stderr, "cannot open %s\n", ptsname(master));
+        delete channel;
+        close(master);
+        return -1;
+    }
+
+    std::vector<long long> sentUs(capsuleCount);
+    std::thread writer([&]() {
+        unsigned char capsule[CAPSULE_SIZE];
+        for (size_t pos = 0; pos < capsuleCount; ++pos) {
+            memset(capsule, (int)(pos & 0xFF), sizeof(capsule));
+            sentUs[pos] = nowUs();
+            if (write(master, capsule, sizeof(capsule)) != (ssize_t)sizeof(capsule)) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    std::vector<long long> latencyUs;
+    latencyUs.reserve(capsuleCount);
+    unsigned char buffer[8192];
+    size_t total = 0;
+    size_t reads = 0;
+    while (total < capsuleCount * CAPSULE_SIZE) {
+        size_t received = 0;
+        if (channel->waitAndRead(buffer, sizeof(buffer), received, 500) != SL_RESULT_OK) {
+            if (total) break;
+            continue;
+        }
+        if (!received) continue;
+
+        long long currentUs = nowUs();
+        ++reads;
+        // every capsule completed by this read
+        for (size_t pos = total / CAPSULE_SIZE; pos < (total + received) / CAPSULE_SIZE; ++pos) {
+            latencyUs.push_back(currentUs - sentUs[pos]);
+        }
+        total += received;
+    }
+
+    writer.join();
+    channel->close();
+    delete channel;
+    close(master);
+
+    if (latencyUs.empty()) {
+        fprintf(stderr, "%s: no capsule received\n", label);
+        return -1;
+    }
+    std::sort(latencyUs.begin(), latencyUs.end());
+    // a non-zero vmin may hold the tail of the stream until more data arrives, it is reported as undelivered
+    printf("  %-40s p50 %6lld us  p99 %6lld us  max %6lld us  (%zu of %zu capsules, %zu reads)\n", label,
+        latencyUs[latencyUs.size() / 2], latencyUs[latencyUs.size() * 99 / 100], latencyUs.back(), latencyUs.size(), capsuleCount, reads);
+    return 0;
+}
+
+}
+
+int bench_serial_latency(int argc, const char* argv[])
+{
+    size_t capsuleCount = argc > 0 ? (size_t)atoi(argv[0]) : 2000;
+    if (!capsuleCount) capsuleCount = 2000;
+
+    printf(" %zu capsules of %zu bytes every 1ms, write to waitAndRead() delivery\n", capsuleCount, CAPSULE_SIZE);
+
+    int ans = 0;
+    SerialPortChannelOptions options;
+    ans |= measureLatency("default", options, capsuleCount);
+
+    options = SerialPortChannelOptions();
+    options.lowLatency = true;
+    ans |= measureLatency("lowLatency", options, capsuleCount);
+
+    options = SerialPortChannelOptions();
+    options.vmin = CAPSULE_SIZE;
+    ans |= measureLatency("vmin=132", options, capsuleCount);
+
+    options = SerialPortChannelOptions();
+    options.readChunkSize = 64;
+    ans |= measureLatency("readChunkSize=64", options, capsuleCount);
+    return ans;
+}
+
+#else
+
+int bench_serial_latency(int argc, const char* argv[])
+{
+    printf(" skipped, the pty loopback is only available on Linux\n");
+    return 0;
+}
+
+#endif
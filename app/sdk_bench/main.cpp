@@ -0,0 +1,78 @@
+/*
+ *  SLAMTEC LIDAR
+ *  SDK Micro Benchmarks
+ *
+ *  Copyright (c) 2014 - 2023 Shanghai Slamtec Co., Ltd.
+ *  http://www.slamtec.com
+ *
+ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+
+volatile size_t bench_sink = 0;
+
+static const struct {
+    const char*  name;
+    bench_proc_t proc;
+    const char*  usage;
+} _benchmarks[] = {
+    { "codec", bench_codec, "[capture_file]  protocol decoding of a loop-mode capsule stream" },
+    { "crc", bench_crc, "CRC32 variants of the HQ capsule validation" },
+    { "scansort", bench_scan_sort, "reordering of a revolution by ILidarDriver::ascendScanData()" },
+    { "geometry", bench_geometry, "polar to cartesian conversion of HQ nodes" },
+    { "serial_latency", bench_serial_latency, "[capsule_count]  delivery latency of the serial channel options on a pty loopback (Linux)" },
+};
+
+static void print_usage(const char* exe)
+{
+    printf("SDK micro benchmarks\n"
+           "Usage: %s [benchmark [args]]\n"
+           "Runs every benchmark when no name is given.\n\n", exe);
+    for (size_t pos = 0; pos < sizeof(_benchmarks) / sizeof(_benchmarks[0]); ++pos) {
+        printf("  %-16s %s\n", _benchmarks[pos].name, _benchmarks[pos].usage);
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    if (argc > 1 && (!strcmp(argv[1], "-h") || !strcmp(argv[1], "--help"))) {
+        print_usage(argv[0]);
+        return 0;
+    }
+
+    int ans = 0;
+    bool found = false;
+    for (size_t pos = 0; pos < sizeof(_benchmarks) / sizeof(_benchmarks[0]); ++pos) {
+        if (argc > 1 && strcmp(argv[1], _benchmarks[pos].name)) continue;
+
+        found = true;
+        printf("[%s]\n", _benchmarks[pos].name);
+        if (_benchmarks[pos].proc(argc > 1 ? argc - 2 : 0, argv + 2)) {
+            ans = -1;
+        }
+    }
+
+    if (!found) {
+        print_usage(argv[0]);
+        return -1;
+    }
+    return ans;
+}
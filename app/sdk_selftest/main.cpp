@@ -0,0 +1,79 @@
+/*
+ *  SLAMTEC LIDAR
+ *  SDK Self Tests
+ *
+ *  Copyright (c) 2014 - 2023 Shanghai Slamtec Co., Ltd.
+ *  http://www.slamtec.com
+ *
+ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+#include "selftest.h"
+
+const char* selftest_data_dir = NULL;
+
+static const struct {
+    const char*     name;
+    selftest_proc_t proc;
+} _tests[] = {
+    { "geometry", test_geometry },
+    { "capsules", test_capsule_kernels },
+};
+
+int main(int argc, const char* argv[])
+{
+    // the data is in the source tree, next to this app, unless told otherwise
+    std::string dataDir = argv[0];
+    size_t separator = dataDir.find_last_of("/\\");
+    dataDir = (separator == std::string::npos ? std::string(".") : dataDir.substr(0, separator)) + "/../../../app/sdk_selftest/data";
+    const char* testName = NULL;
+    for (int pos = 1; pos < argc; ++pos) {
+        if (!strcmp(argv[pos], "-d") && pos + 1 < argc) {
+            dataDir = argv[++pos];
+        }
+        else {
+            testName = argv[pos];
+        }
+    }
+    selftest_data_dir = dataDir.c_str();
+
+    int failedTests = 0;
+    bool found = false;
+    for (size_t pos = 0; pos < sizeof(_tests) / sizeof(_tests[0]); ++pos) {
+        if (testName && strcmp(testName, _tests[pos].name)) continue;
+
+        found = true;
+        printf("[%s]\n", _tests[pos].name);
+        int failures = _tests[pos].proc();
+        printf("  %s\n", failures ? "FAILED" : "passed");
+        if (failures) ++failedTests;
+    }
+
+    if (!found) {
+        printf("Usage: %s [-d data_dir] [test]\nRuns every test when no name is given, the available tests are:\n", argv[0]);
+        for (size_t pos = 0; pos < sizeof(_tests) / sizeof(_tests[0]); ++pos) {
+            printf("  %s\n", _tests[pos].name);
+        }
+        return -1;
+    }
+
+    return failedTests ? 1 : 0;
+}
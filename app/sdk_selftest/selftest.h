@@ -0,0 +1,70 @@
+/*
+ *  SLAMTEC LIDAR
+ *  SDK Self Tests
+ *
+ *  Copyright (c) 2014 - 2023 Shanghai Slamtec Co., Ltd.
+ *  http://www.slamtec.com
+ *
+ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stddef.h>
+
+// every test returns the number of failed checks
+typedef int (*selftest_proc_t)();
+
+int test_geometry();
+int test_capsule_kernels();
+
+// where the recorded device data used by the tests is stored
+extern const char* selftest_data_dir;
+
+#define SELFTEST_CHECK(_cond_, ...) do {            \
+        if (!(_cond_)) {                            \
+            printf("  FAILED %s:%d: ", __FILE__, __LINE__); \
+            printf(__VA_ARGS__);                    \
+            printf("\n");                           \
+            ++failures;                             \
+        }                                           \
+    } while (0)
+
+// deterministic generator, the tests must not depend on the C library rand()
+class SelftestRandom
+{
+public:
+    SelftestRandom(unsigned int seed) : _state(seed * 2654435761u + 1) {}
+
+    unsigned int next()
+    {
+        // xorshift32
+        _state ^= _state << 13;
+        _state ^= _state >> 17;
+        _state ^= _state << 5;
+        return _state;
+    }
+
+    unsigned int next(unsigned int range)
+    {
+        return next() % range;
+    }
+
+private:
+    unsigned int _state;
+};
@@ -0,0 +1,238 @@
+/*
+ *  SLAMTEC LIDAR
+ *  SDK Self Tests
+ *
+ *  Copyright (c) 2014 - 2023 Shanghai Slamtec Co., Ltd.
+ *  http://www.slamtec.com
+ *
+ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "sl_lidar_driver.h"
+#include "dataunpacker/dataunnpacker_commondef.h"
+#include "dataunpacker/dataunpacker.h"
+#include "dataunpacker/unpacker/capsule_kernels.h"
+
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "selftest.h"
+
+using namespace sl::internal;
+
+namespace {
+
+int fuzzPackCapsuleSamples(SelftestRandom& random)
+{
+    int failures = 0;
+    const int maxCount = 128;
+    rplidar_response_measurement_node_hq_t nodes[maxCount], refNodes[maxCount];
+    int dist_q2[maxCount];
+    _u8 quality[maxCount];
+
+    for (int round = 0; round < 200000 && !failures; ++round) {
+        size_t count = random.next(maxCount + 1);
+        // the handlers pass the 15 bit start angle of the capsule shifted to q16,
+        // which may exceed 360 degrees on corrupted data
+        int startAngle_raw_q16 = (int)(random.next(0x8000) << 10);
+        int angleInc_q16 = (int)random.next(round & 1 ? (2 << 16) : (90 << 16) / 40);
+        int syncWindow_q16 = angleInc_q16 << 1;
+        for (size_t pos = 0; pos < count; ++pos) {
+            dist_q2[pos] = (int)random.next(0x40000);
+            quality[pos] = (_u8)random.next(256);
+        }
+
+        memset(nodes, 0xCC, sizeof(nodes));
+        memset(refNodes, 0xCC, sizeof(refNodes));
+        unpacker::packCapsuleSamplesScalar(refNodes, dist_q2, quality, count, startAngle_raw_q16, angleInc_q16, syncWindow_q16);
+        unpacker::packCapsuleSamples(nodes, dist_q2, quality, count, startAngle_raw_q16, angleInc_q16, syncWindow_q16);
+
+        SELFTEST_CHECK(!memcmp(nodes, refNodes, sizeof(nodes)), "packCapsuleSamples: differs from the scalar result, count=%zu startAngle_raw_q16=%d angleInc_q16=%d",
+            count, startAngle_raw_q16, angleInc_q16);
+    }
+    return failures;
+}
+
+int fuzzDecodeUltraDenseSamples(SelftestRandom& random)
+{
+    int failures = 0;
+    const int maxCount = 128;
+    int dist_q2[maxCount], refDist_q2[maxCount];
+    _u8 quality[maxCount], refQuality[maxCount];
+    _u32 qualityDistScale[maxCount];
+
+    for (int round = 0; round < 200000 && !failures; ++round) {
+        size_t count = random.next(maxCount + 1);
+        for (size_t pos = 0; pos < count; ++pos) {
+            // 20 bit words, the upper bits are random on a part of the rounds to check they are ignored
+            qualityDistScale[pos] = round & 1 ? random.next() : (random.next() & 0xFFFFF);
+        }
+
+        memset(dist_q2, 0xCC, sizeof(dist_q2));
+        memset(refDist_q2, 0xCC, sizeof(refDist_q2));
+        memset(quality, 0xCC, sizeof(quality));
+        memset(refQuality, 0xCC, sizeof(refQuality));
+        unpacker::decodeUltraDenseSamplesScalar(refDist_q2, refQuality, qualityDistScale, count);
+        unpacker::decodeUltraDenseSamples(dist_q2, quality, qualityDistScale, count);
+
+        SELFTEST_CHECK(!memcmp(dist_q2, refDist_q2, sizeof(dist_q2)) && !memcmp(quality, refQuality, sizeof(quality)),
+            "decodeUltraDenseSamples: differs from the scalar result, count=%zu", count);
+    }
+    return failures;
+}
+
+// Describes everything the unpacker publishes, one line per event. The timestamps are
+// relative to the last node of each batch, so they do not depend on the local clock.
+class ReplayRecorder : public LIDARSampleDataListener
+{
+public:
+    std::vector<std::string> lines;
+
+    virtual void onHQNodeScanResetReq()
+    {
+        lines.push_back("reset");
+    }
+
+    virtual void onHQNodeDecoded(_u64 timestamp_uS, const rplidar_response_measurement_node_hq_t* node)
+    {
+        onHQNodesDecoded(node, &timestamp_uS, 1);
+    }
+
+    virtual void onHQNodesDecoded(const rplidar_response_measurement_node_hq_t* nodes, const _u64* timestamp_uS, size_t count)
+    {
+        _u64 hash = 14695981039346656037ULL;
+        for (size_t pos = 0; pos < count; ++pos) {
+            hash = _mix(hash, nodes[pos].angle_z_q14, 2);
+            hash = _mix(hash, nodes[pos].dist_mm_q2, 4);
+            hash = _mix(hash, nodes[pos].quality, 1);
+            hash = _mix(hash, nodes[pos].flag, 1);
+            hash = _mix(hash, timestamp_uS[count - 1] - timestamp_uS[pos], 8);
+        }
+
+        char line[64];
+        snprintf(line, sizeof(line), "nodes %zu %016llx", count, (unsigned long long)hash);
+        lines.push_back(line);
+    }
+
+    virtual void onDecodingError(int errMsg, _u8 ansType, const void* payload, size_t size)
+    {
+        char line[64];
+        snprintf(line, sizeof(line), "error %x", errMsg);
+        lines.push_back(line);
+    }
+
+private:
+    // FNV-1a over the little endian bytes of the value
+    static _u64 _mix(_u64 hash, _u64 value, int bytes)
+    {
+        for (int pos = 0; pos < bytes; ++pos) {
+            hash = (hash ^ ((value >> (pos * 8)) & 0xFF)) * 1099511628211ULL;
+        }
+        return hash;
+    }
+};
+
+bool loadFile(const std::string& path, std::vector<_u8>& data)
+{
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (!fp) return false;
+
+    _u8 buffer[4096];
+    size_t size;
+    data.clear();
+    while ((size = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+        data.insert(data.end(), buffer, buffer + size);
+    }
+    fclose(fp);
+    return true;
+}
+
+bool loadLines(const std::string& path, std::vector<std::string>& lines)
+{
+    FILE* fp = fopen(path.c_str(), "r");
+    if (!fp) return false;
+
+    char line[256];
+    lines.clear();
+    while (fgets(line, sizeof(line), fp)) {
+        line[strcspn(line, "\r\n")] = 0;
+        lines.push_back(line);
+    }
+    fclose(fp);
+    return true;
+}
+
+// Feeds a capsule capture to the unpacker in irregular chunks and compares what it
+// publishes with the output of the handlers before the batched kernels were introduced.
+int replayCapture(const char* name, _u8 ansType, const sl::SlamtecLidarTimingDesc& timing)
+{
+    int failures = 0;
+    std::string basePath = std::string(selftest_data_dir) + "/" + name;
+
+    std::vector<_u8> capture;
+    std::vector<std::string> expected;
+    if (!loadFile(basePath + ".bin", capture) || !loadLines(basePath + ".golden", expected)) {
+        SELFTEST_CHECK(false, "%s: cannot load the capture and its golden output from %s", name, selftest_data_dir);
+        return failures;
+    }
+
+    ReplayRecorder recorder;
+    LIDARSampleDataUnpacker* unpacker = LIDARSampleDataUnpacker::CreateInstance(recorder);
+    unpacker->updateUnpackerContext(LIDARSampleDataUnpacker::UNPACKER_CONTEXT_TYPE_LIDAR_TIMING, &timing, sizeof(timing));
+    unpacker->enable();
+
+    size_t chunkSize = 1;
+    for (size_t pos = 0; pos < capture.size(); pos += chunkSize) {
+        chunkSize = std::min<size_t>(chunkSize * 7 % 997 + 1, capture.size() - pos);
+        unpacker->onSampleData(ansType, &capture[pos], chunkSize);
+    }
+    delete unpacker;
+
+    size_t lineCount = std::min(expected.size(), recorder.lines.size());
+    for (size_t pos = 0; pos < lineCount; ++pos) {
+        if (expected[pos] != recorder.lines[pos]) {
+            SELFTEST_CHECK(false, "%s: event %zu is \"%s\" instead of \"%s\"", name, pos, recorder.lines[pos].c_str(), expected[pos].c_str());
+            return failures;
+        }
+    }
+    SELFTEST_CHECK(expected.size() == recorder.lines.size(), "%s: %zu events published instead of %zu", name, recorder.lines.size(), expected.size());
+    printf("  %s: %zu events replayed\n", name, recorder.lines.size());
+    return failures;
+}
+
+}
+
+int test_capsule_kernels()
+{
+    int failures = 0;
+    SelftestRandom random(20);
+
+    failures += fuzzPackCapsuleSamples(random);
+    failures += fuzzDecodeUltraDenseSamples(random);
+
+    sl::SlamtecLidarTimingDesc timing;
+    memset(&timing, 0, sizeof(timing));
+    timing.sample_duration_uS = 31;
+    timing.native_baudrate = 1000000;
+    timing.linkage_delay_uS = 50;
+
+    failures += replayCapture("dense_capsules", SL_LIDAR_ANS_TYPE_MEASUREMENT_DENSE_CAPSULED, timing);
+    failures += replayCapture("ultra_dense_capsules", SL_LIDAR_ANS_TYPE_MEASUREMENT_ULTRA_DENSE_CAPSULED, timing);
+    return failures;
+}
@@ -0,0 +1,122 @@
+/*
+ *  SLAMTEC LIDAR
+ *  SDK Self Tests
+ *
+ *  Copyright (c) 2014 - 2023 Shanghai Slamtec Co., Ltd.
+ *  http://www.slamtec.com
+ *
+ */
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "sl_lidar_driver.h"
+#include "sl_lidar_geometry.h"
+#include "sl_lidar_geometry_internal.h"
+
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+#include "selftest.h"
+
+using namespace sl::geometry;
+
+namespace {
+
+void generateNodes(SelftestRandom& random, std::vector<sl_lidar_response_measurement_node_hq_t>& nodes, size_t count)
+{
+    nodes.resize(count);
+    for (size_t pos = 0; pos < count; ++pos) {
+        nodes[pos].angle_z_q14 = (sl_u16)random.next(0x10000);
+        // up to 4000 meters, far more than any device measures
+        nodes[pos].dist_mm_q2 = random.next(16000000);
+        nodes[pos].quality = (sl_u8)random.next(256);
+        nodes[pos].flag = (sl_u8)random.next(256);
+    }
+}
+
+int compareWithScalar(const char* name, internal::convert_proc_t convert, const std::vector<sl_lidar_response_measurement_node_hq_t>& nodes, bool withIntensity)
+{
+    int failures = 0;
+    size_t count = nodes.size();
+    std::vector<float> refX(count), refY(count), refIntensity(count);
+    std::vector<float> x(count), y(count), intensity(count);
+
+    polarToCartesianScalar(&nodes[0], count, &refX[0], &refY[0], withIntensity ? &refIntensity[0] : NULL);
+    convert(&nodes[0], count, &x[0], &y[0], withIntensity ? &intensity[0] : NULL);
+
+    size_t mismatches = 0;
+    size_t firstMismatch = 0;
+    for (size_t pos = 0; pos < count; ++pos) {
+        bool same = !memcmp(&x[pos], &refX[pos], sizeof(float)) && !memcmp(&y[pos], &refY[pos], sizeof(float));
+        if (withIntensity) same = same && !memcmp(&intensity[pos], &refIntensity[pos], sizeof(float));
+        if (!same && !mismatches++) firstMismatch = pos;
+    }
+
+    SELFTEST_CHECK(!mismatches, "%s: %zu of %zu nodes differ from the scalar result, e.g. angle_q14=%u dist_q2=%u gives (%g, %g) instead of (%g, %g)",
+        name, mismatches, count, mismatches ? nodes[firstMismatch].angle_z_q14 : 0, mismatches ? nodes[firstMismatch].dist_mm_q2 : 0,
+        mismatches ? x[firstMismatch] : 0, mismatches ? y[firstMismatch] : 0, mismatches ? refX[firstMismatch] : 0, mismatches ? refY[firstMismatch] : 0);
+    return failures;
+}
+
+}
+
+int test_geometry()
+{
+    int failures = 0;
+
+    // the scalar reference against libm, the table step is 90 / 16384 degree
+    for (sl_u32 angle = 0; angle < 0x10000; ++angle) {
+        sl_lidar_response_measurement_node_hq_t node;
+        memset(&node, 0, sizeof(node));
+        node.angle_z_q14 = (sl_u16)angle;
+        node.dist_mm_q2 = 40000;
+
+        float x, y;
+        polarToCartesianScalar(&node, 1, &x, &y, NULL);
+
+        double rad = angle * 1.57079632679489661923 / 16384;
+        double expectedX = 10000 * cos(rad), expectedY = 10000 * sin(rad);
+        if (fabs(x - expectedX) > 0.01 || fabs(y - expectedY) > 0.01) {
+            SELFTEST_CHECK(false, "scalar: angle_q14=%u gives (%g, %g) instead of (%g, %g)", angle, x, y, expectedX, expectedY);
+            break;
+        }
+    }
+
+    // every vectorized path must match the scalar one bit for bit, including the tails
+    internal::ConvertVariant variants[8];
+    size_t variantCount = internal::getConvertVariants(variants, sizeof(variants) / sizeof(variants[0]));
+
+    SelftestRandom random(12);
+    static const size_t counts[] = { 1, 3, 4, 7, 8, 9, 15, 16, 17, 12800 };
+    std::vector<sl_lidar_response_measurement_node_hq_t> nodes;
+    for (size_t countPos = 0; countPos < sizeof(counts) / sizeof(counts[0]); ++countPos) {
+        generateNodes(random, nodes, counts[countPos]);
+        for (int withIntensity = 0; withIntensity < 2; ++withIntensity) {
+            for (size_t pos = 1; pos < variantCount; ++pos) {
+                failures += compareWithScalar(variants[pos].name, variants[pos].convert, nodes, withIntensity != 0);
+            }
+            failures += compareWithScalar("polarToCartesian", polarToCartesian, nodes, withIntensity != 0);
+        }
+    }
+
+    printf("  checked:");
+    for (size_t pos = 0; pos < variantCount; ++pos) {
+        printf(" %s", variants[pos].name);
+    }
+    printf("\n");
+    return failures;
+}
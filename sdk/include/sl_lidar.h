@@ -34,6 +34,7 @@
 #pragma once
 
 #include "sl_lidar_driver.h"
+#include "sl_lidar_geometry.h"
 
 #define SL_LIDAR_SDK_VERSION_MAJOR  2
 #define SL_LIDAR_SDK_VERSION_MINOR  1
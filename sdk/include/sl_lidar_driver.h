@@ -38,6 +38,7 @@
 #include <vector>
 #include <map>
 #include <string>
+#include <memory>
 
 #ifndef DEPRECATED
     #ifdef __GNUC__
@@ -233,6 +234,46 @@ namespace sl {
 
         virtual int getChannelType() = 0;
 
+        /**
+        * Wait for incoming data and read what is available in one call
+        * The default implementation combines waitForDataExt() and read(), channels may override it
+        * to wait and read with fewer system calls.
+        * \param buffer The buffer to receive data
+        * \param size The size of the read buffer
+        * \param received [out] Bytes read, can be 0 even if RESULT_OK is returned
+        * \param timeoutInMs Wait timeout (in milliseconds)
+        * \return RESULT_OK if the wait succeeded
+        *         RESULT_OPERATION_TIMEOUT if the given timeout duration is exceed
+        *         RESULT_OPERATION_FAIL or RESULT_OPERATION_ABORTED if there is something wrong with the channel
+        */
+        virtual sl_result waitAndRead(void* buffer, size_t size, size_t& received, sl_u32 timeoutInMs = 1000)
+        {
+            size_t hintedSize = 0;
+            received = 0;
+
+            sl_result ans = waitForDataExt(hintedSize, timeoutInMs);
+            if (SL_IS_FAIL(ans)) return ans;
+            if (!hintedSize) return SL_RESULT_OK;
+
+            int rxSize = read(buffer, hintedSize < size ? hintedSize : size);
+            if (rxSize <= 0) return SL_RESULT_OPERATION_ABORTED;
+
+            received = (size_t)rxSize;
+            return SL_RESULT_OK;
+        }
+
+        /**
+        * Get the time when the data returned by the last read()/waitAndRead() was received
+        * Channels backed by kernel receive timestamps (SO_TIMESTAMPNS on Linux) report the arrival time of
+        * the latest byte returned, in the same time base as the timestamps of the measurement samples.
+        * The sample timestamps are then free of the scheduling delay of the SDK threads.
+        * \return The receive timestamp in microseconds, 0 if the channel does not provide it
+        */
+        virtual sl_u64 getLastReadTimestamp_uS()
+        {
+            return 0;
+        }
+
     private:
 
     };
@@ -259,6 +300,47 @@ namespace sl {
     */
     Result<IChannel*> createSerialPortChannel(const std::string& device, int baudrate);
 
+    /**
+    * Tuning options of the serial channel
+    */
+    struct SerialPortChannelOptions
+    {
+        SerialPortChannelOptions()
+            : lowLatency(false)
+            , vmin(0)
+            , vtime(0)
+            , readChunkSize(0)
+        {}
+
+        /**
+        * Ask the driver to deliver the received data without batching it
+        * (ASYNC_LOW_LATENCY on Linux, USB-serial adapters otherwise hold the data up to their 16ms latency timer)
+        */
+        bool lowLatency;
+
+        /**
+        * termios VMIN/VTIME of the port (Unix-Like OS only)
+        * They are meant for blocking reads. The channel waits for the port to become readable and then
+        * reads it without blocking, where a non-zero vmin does not coalesce the data on Linux and may
+        * split the reads, so keep the defaults (0) unless the port is also read elsewhere
+        */
+        sl_u8 vmin;
+        sl_u8 vtime;
+
+        /**
+        * Maximum bytes taken from the port per read, 0 for no limit
+        */
+        sl_u32 readChunkSize;
+    };
+
+    /**
+    * Create a serial channel with tuning options
+    * \param device Serial port device
+    * \param baudrate Baudrate
+    * \param options Tuning options
+    */
+    Result<IChannel*> createSerialPortChannel(const std::string& device, int baudrate, const SerialPortChannelOptions& options);
+
     /**
     * Create a TCP channel
     * \param ip IP address of the device
@@ -266,6 +348,34 @@ namespace sl {
     */
     Result<IChannel*> createTcpChannel(const std::string& ip, int port);
 
+    /**
+    * Abstract interface of UDP channel
+    * The channel returned by createUdpChannel() implements this interface,
+    * it is safe to cast when getChannelType() returns CHANNEL_TYPE_UDP
+    */
+    class IUdpChannel : public IChannel
+    {
+    public:
+        virtual ~IUdpChannel() {}
+
+    public:
+        /**
+        * Set the kernel receive buffer size (SO_RCVBUF) of the socket
+        * A larger buffer absorbs the bursts of a high sample rate lidar while the receiver thread is not scheduled.
+        * The value is kept and applied again when the channel is reopened
+        * \param size Buffer size in bytes, the OS may adjust or cap it
+        */
+        virtual sl_result setReceiveBufferSize(size_t size) = 0;
+
+        /**
+        * Get the number of datagrams dropped by the kernel because the receive buffer was full
+        * The counter is updated as datagrams are received, so drops are reported once the data flows again
+        * \param count [out] Total number of dropped datagrams since the socket was opened
+        * \return SL_RESULT_OPERATION_NOT_SUPPORT if the platform does not report it
+        */
+        virtual sl_result getKernelDropCount(sl_u64& count) = 0;
+    };
+
     /**
     * Create a UDP channel
     * \param ip IP address of the device
@@ -286,6 +396,19 @@ namespace sl {
         CHANNEL_TYPE_UDP = 0x2,
     };
 
+    /**
+    * Flags of ILidarDriver::connect
+    */
+    enum LidarConnectFlag
+    {
+        /**
+        * Read and decode the incoming data in the same thread instead of handing it
+        * from a receiver thread to a decoder thread. Saves one thread and one context switch per read,
+        * useful when a host drives several LIDARs. A slow sample sink then delays the reading of the channel.
+        */
+        CONNECT_FLAG_SINGLE_THREAD = 0x1,
+    };
+
         /**
     * Lidar motor info
     */
@@ -303,6 +426,164 @@ namespace sl {
         sl_u16 min_speed;
     };
 
+    /**
+    * A complete scan in structure-of-arrays layout, see ILidarDriver::grabScanFrame
+    * Every array starts at a DATA_ALIGNMENT bytes aligned address and is padded to a multiple of DATA_ALIGNMENT bytes,
+    * so SIMD code can use aligned loads and may read (but not rely on the values) up to the padded end.
+    */
+    class LidarScanFrame
+    {
+    public:
+        enum {
+            DATA_ALIGNMENT = 32,
+        };
+
+        LidarScanFrame();
+        ~LidarScanFrame();
+
+        /// Make room for at least capacity samples
+        /// The existing samples are discarded if the storage has to grow.
+        bool reserve(size_t capacity);
+
+        size_t getCapacity() const { return _capacity; }
+
+        /// Copy the samples and the scan info of another frame, the storage grows if needed
+        bool copyFrom(const LidarScanFrame& src);
+
+        sl_u16* getAngles_q14() { return _angle_z_q14; }
+        const sl_u16* getAngles_q14() const { return _angle_z_q14; }
+
+        sl_u32* getDistances_q2() { return _dist_mm_q2; }
+        const sl_u32* getDistances_q2() const { return _dist_mm_q2; }
+
+        sl_u8* getQualities() { return _quality; }
+        const sl_u8* getQualities() const { return _quality; }
+
+        sl_u8* getFlags() { return _flag; }
+        const sl_u8* getFlags() const { return _flag; }
+
+        /// Timestamp of each sample relative to begin_timestamp_uS (in microseconds)
+        sl_s32* getTimestampOffsets_uS() { return _timestamp_offset_uS; }
+        const sl_s32* getTimestampOffsets_uS() const { return _timestamp_offset_uS; }
+
+        // count of the valid samples, never exceeds the capacity
+        size_t count;
+
+        // timestamp of the first and the last sample of the scan (in microseconds), see grabScanDataHqWithTimeStamp
+        sl_u64 begin_timestamp_uS;
+        sl_u64 end_timestamp_uS;
+
+        // see ILidarScanLease::getScanSequence
+        sl_u64 scan_sequence;
+
+        // true if the samples have been motion compensated, see ILidarDriver::setPoseProvider
+        bool   motion_compensated;
+
+    private:
+        LidarScanFrame(const LidarScanFrame&);
+        LidarScanFrame& operator=(const LidarScanFrame&);
+
+        void*   _storage;
+        size_t  _capacity;
+        sl_u16* _angle_z_q14;
+        sl_u32* _dist_mm_q2;
+        sl_s32* _timestamp_offset_uS;
+        sl_u8*  _quality;
+        sl_u8*  _flag;
+    };
+
+    /**
+    * Read-only lease on a complete scan held by the driver
+    * The scan buffer is returned to the driver's buffer pool once the last reference of the lease is released
+    */
+    class ILidarScanLease
+    {
+    public:
+        virtual ~ILidarScanLease() {}
+
+        /// The nodes of the scan, nodes[0] is the first sample of the scan (start_bit == 1)
+        virtual const sl_lidar_response_measurement_node_hq_t* getNodes() const = 0;
+
+        virtual size_t getNodeCount() const = 0;
+
+        /// Timestamp of the first node of the scan (in microseconds), see grabScanDataHqWithTimeStamp
+        virtual sl_u64 getBeginTimestamp_uS() const = 0;
+
+        /// Sequence number of the scan, increased by one for every completed scan
+        /// A gap between two leases means some scans were skipped
+        virtual sl_u64 getScanSequence() const = 0;
+
+        /// The same scan in structure-of-arrays layout
+        virtual const LidarScanFrame& getFrame() const = 0;
+    };
+
+    typedef std::shared_ptr<const ILidarScanLease> LidarScanLeasePtr;
+
+    /**
+    * Pose of the LIDAR on a plane
+    */
+    struct LidarPose2D
+    {
+        // Time of the pose, in the same time base as the sample timestamps (in microseconds)
+        sl_u64 timestamp_uS;
+
+        // Position in a fixed frame (e.g. odometry), in millimeters
+        double x;
+        double y;
+
+        // Heading in radians, counter-clockwise, 0 means the LIDAR's 0 degree points along the x axis
+        double yaw;
+    };
+
+    /**
+    * Source of the LIDAR poses used for motion compensation, see ILidarDriver::setPoseProvider
+    *
+    * getPoseAt is called from the driver's internal decoder thread, the same threading contract as
+    * ILidarSampleSink applies.
+    */
+    class ILidarPoseProvider
+    {
+    public:
+        virtual ~ILidarPoseProvider() {}
+
+        /// Interpolate (or extrapolate) the pose of the LIDAR at the given time
+        /// \return false if the pose is not available, the current scan will then be left uncompensated
+        virtual bool getPoseAt(sl_u64 timestamp_uS, LidarPose2D& pose) = 0;
+    };
+
+    /**
+    * Receiver of the decoded sample data in push mode, see ILidarDriver::setSampleSink
+    *
+    * Threading contract:
+    * 1) All the callbacks are invoked from the driver's internal decoder thread, never concurrently with each other.
+    * 2) The data pointers are only valid during the callback, copy the data out if it is needed later.
+    * 3) The callbacks must return quickly, the decoder thread cannot consume the incoming data meanwhile.
+    * 4) The callbacks must NOT call any ILidarDriver operation that talks to the LIDAR (e.g. stop, getDeviceInfo),
+    *    since the response would have to be decoded by the very thread being blocked.
+    */
+    class ILidarSampleSink
+    {
+    public:
+        virtual ~ILidarSampleSink() {}
+
+        /// A batch of decoded samples, typically all the samples of one received packet
+        /// \param nodes          The decoded samples
+        /// \param timestamps_uS  The timestamp of each sample (in microseconds), see grabScanDataHqWithTimeStamp
+        /// \param count          The count of the samples
+        virtual void onSamplesDecoded(const sl_lidar_response_measurement_node_hq_t* nodes, const sl_u64* timestamps_uS, size_t count) {}
+
+        /// A complete 0-360 degree scan has been formed
+        /// The scan data has the same charactistics as the one returned by grabScanDataHq.
+        /// \param beginTimestamp_uS  Timestamp of the first node of the scan (in microseconds)
+        /// \param scanSequence       Sequence number of the scan, see ILidarScanLease::getScanSequence
+        virtual void onScanCompleted(const sl_lidar_response_measurement_node_hq_t* nodes, size_t count, sl_u64 beginTimestamp_uS, sl_u64 scanSequence) {}
+
+        /// A partial scan has been completed, see ILidarDriver::setScanSectorMode
+        /// \param beginTimestamp_uS  Timestamp of the first node of the sector (in microseconds)
+        /// \param sectorSequence     Sequence number of the sector, increased by one for every completed sector
+        virtual void onScanSectorCompleted(const sl_lidar_response_measurement_node_hq_t* nodes, size_t count, sl_u64 beginTimestamp_uS, sl_u64 sectorSequence) {}
+    };
+
     class ILidarDriver
     {
     public:
@@ -316,6 +597,13 @@ namespace sl {
         */
         virtual sl_result connect(IChannel* channel) = 0;
 
+        /**
+        * Connect to LIDAR via channel with options
+        * \param channel The communication channel
+        * \param flags   Combination of LidarConnectFlag, kept until disconnect() (e.g. when negotiateSerialBaudRate() reopens the channel)
+        */
+        virtual sl_result connect(IChannel* channel, sl_u32 flags) = 0;
+
         /**
         * Disconnect from the LIDAR
         */
@@ -536,6 +824,109 @@ namespace sl {
         /// \param timeout           The timeout value used by potential data communication
         virtual sl_result getModelNameDescriptionString(std::string& out_description, bool fetchAliasName = true, const sl_lidar_response_device_info_t* devInfo = nullptr, sl_u32 timeout = DEFAULT_TIMEOUT) = 0;
 
+        /// Wait and lease the latest complete 0-360 degree scan without copying it.
+        /// The scan data has the same charactistics as the one returned by grabScanDataHqWithTimeStamp.
+        ///
+        /// The leased buffer is owned by the caller until the lease is released, the driver keeps receiving
+        /// new scans into its other buffers meanwhile. Up to 4 leases can be held at the same time.
+        ///
+        /// \param outLease      The lease of the scan data
+        /// \param timeout       Max duration allowed to wait for a complete scan data
+        ///
+        /// The interface will return SL_RESULT_OPERATION_TIMEOUT to indicate that no complete 360-degrees' scan can be retrieved withing the given timeout duration,
+        /// or SL_RESULT_INSUFFICIENT_MEMORY if too many leases are still held by the caller.
+        virtual sl_result grabScanDataLease(LidarScanLeasePtr& outLease, sl_u32 timeout = DEFAULT_TIMEOUT) = 0;
+
+        /// Get the count of the samples discarded because getScanDataWithIntervalHq was not called frequently enough
+        /// The driver caches up to 8192 samples in between two calls of getScanDataWithIntervalHq.
+        virtual sl_u64 getDroppedIntervalSampleCount() = 0;
+
+        /// Register a sink to receive the decoded samples and scans in push mode, without waiting or copying.
+        /// The polling interfaces (grabScanDataHq etc.) keep working when a sink is registered.
+        /// See ILidarSampleSink for the threading contract.
+        ///
+        /// \param sink          The sink to be used, or NULL to unregister the current one
+        ///                      Note: a callback may still be running when setSampleSink(NULL) returns,
+        ///                      keep the sink alive until the driver is disconnected or destroyed
+        virtual sl_result setSampleSink(ILidarSampleSink* sink) = 0;
+
+        /// Wait and grab the latest complete 0-360 degree scan in structure-of-arrays layout
+        /// The scan data has the same charactistics as the one returned by grabScanDataHqWithTimeStamp.
+        /// The frame object can be reused for the next call, its storage only grows when needed.
+        ///
+        /// \param frame         The frame to store the scan data
+        /// \param timeout       Max duration allowed to wait for a complete scan data
+        ///
+        /// The interface will return SL_RESULT_OPERATION_TIMEOUT to indicate that no complete 360-degrees' scan can be retrieved withing the given timeout duration.
+        virtual sl_result grabScanFrame(LidarScanFrame& frame, sl_u32 timeout = DEFAULT_TIMEOUT) = 0;
+
+        /// Wait and grab a complete 0-360 degree scan data together with the timestamp of every sample
+        /// The scan data has the same charactistics as the one returned by grabScanDataHqWithTimeStamp.
+        /// The timestamp of nodebuffer[i] is timestamp_uS + timestampOffsets_uS[i], which allows to compensate
+        /// the motion of the LIDAR during the scan.
+        ///
+        /// \param nodebuffer           Buffer provided by the caller application to store the scan data
+        /// \param timestampOffsets_uS  Buffer provided by the caller application to store the timestamp offset of each sample (in microseconds),
+        ///                             it must have the same size as nodebuffer
+        /// \param count                The number of nodes the buffers can hold. Once the interface returns, this parameter will store the actual received data count.
+        /// \param timestamp_uS         The timestamp of the first node of the scan (in microseconds)
+        /// \param timeout              Max duration allowed to wait for a complete scan data
+        ///
+        /// The interface will return SL_RESULT_OPERATION_TIMEOUT to indicate that no complete 360-degrees' scan can be retrieved withing the given timeout duration.
+        virtual sl_result grabScanDataHqWithSampleTimeStamps(sl_lidar_response_measurement_node_hq_t* nodebuffer, sl_s32* timestampOffsets_uS, size_t& count, sl_u64& timestamp_uS, sl_u32 timeout = DEFAULT_TIMEOUT) = 0;
+
+        /// Enable the motion compensation (de-skew) of the complete scans
+        /// Every sample is moved into the LIDAR's frame at the time of the last sample of its scan,
+        /// using the pose of the LIDAR at the sample's timestamp. The work is done while the samples arrive.
+        /// It applies to grabScanDataHq and the related interfaces, the scan leases/frames and ILidarSampleSink::onScanCompleted.
+        /// The interval samples (getScanDataWithIntervalHq, ILidarSampleSink::onSamplesDecoded) are not affected.
+        /// Use LidarScanFrame::motion_compensated to tell whether a scan could be compensated.
+        ///
+        /// \param provider      The pose source, or NULL to disable the motion compensation
+        ///                      It takes effect from the next scan. Keep the provider alive until the driver is disconnected or destroyed.
+        virtual sl_result setPoseProvider(ILidarPoseProvider* provider) = 0;
+
+        /// Enable the delivery of partial scans (sectors), which become available long before the revolution is complete
+        /// A sector is closed when any of the enabled conditions is met, and always at the beginning of a new revolution.
+        /// The sectors carry the samples as received, they are not motion compensated.
+        ///
+        /// \param sectorAngle_q14     Close the sector when the scan crosses a multiple of this angle (q14 format, 16384 means 90 degrees), 0 to disable
+        /// \param sectorSampleCount   Close the sector once it holds this many samples, 0 to disable
+        ///
+        /// The sector delivery is disabled when both values are 0 (default).
+        virtual sl_result setScanSectorMode(sl_u32 sectorAngle_q14, sl_u32 sectorSampleCount = 0) = 0;
+
+        /// Wait and grab the latest completed sector, see setScanSectorMode
+        ///
+        /// \param nodebuffer           Buffer provided by the caller application to store the sector data
+        /// \param count                The number of nodes the buffer can hold. Once the interface returns, this parameter will store the actual received data count.
+        /// \param timestamp_uS         The timestamp of the first node of the sector (in microseconds)
+        /// \param sectorSequence       Sequence number of the sector, a gap between two calls means some sectors were skipped
+        /// \param timeout              Max duration allowed to wait for a sector
+        ///
+        /// The interface will return SL_RESULT_OPERATION_TIMEOUT to indicate that no sector has been completed withing the given timeout duration.
+        virtual sl_result grabScanSectorHq(sl_lidar_response_measurement_node_hq_t* nodebuffer, size_t& count, sl_u64& timestamp_uS, sl_u64& sectorSequence, sl_u32 timeout = DEFAULT_TIMEOUT) = 0;
+
+        /// Keep a history of the latest complete scans, so a consumer that stalls for a while does not lose any of them
+        /// The storage of all the scans is allocated by this call, nothing is allocated while scanning.
+        /// The history is independent of grabScanDataHq and the other interfaces returning the latest scan.
+        ///
+        /// \param depth         The number of scans to keep, 0 to disable the history (default)
+        virtual sl_result setScanHistoryDepth(size_t depth) = 0;
+
+        /// Wait and fetch the oldest scan of the history that has not been fetched yet, see setScanHistoryDepth
+        /// The scans are returned in order, use LidarScanFrame::scan_sequence to detect the scans lost due to an overflow.
+        ///
+        /// \param frame         The frame to store the scan data
+        /// \param timeout       Max duration allowed to wait for a complete scan data
+        ///
+        /// The interface will return SL_RESULT_OPERATION_TIMEOUT to indicate that no scan is available withing the given timeout duration,
+        /// or SL_RESULT_OPERATION_NOT_SUPPORT if the history is disabled.
+        virtual sl_result grabNextHistoryScan(LidarScanFrame& frame, sl_u32 timeout = DEFAULT_TIMEOUT) = 0;
+
+        /// Get the count of the scans dropped from the history before grabNextHistoryScan could fetch them
+        virtual sl_u64 getDroppedHistoryScanCount() = 0;
+
 };
 
     /**
@@ -0,0 +1,59 @@
+/*
+* Slamtec LIDAR SDK
+*
+* sl_lidar_geometry.h
+*
+* Copyright (c) 2020 Shanghai Slamtec Co., Ltd.
+*/
+
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include "sl_lidar_cmd.h"
+#include <stddef.h>
+
+namespace sl { namespace geometry {
+
+    /// Convert HQ measurement nodes to Cartesian coordinates in structure-of-arrays layout
+    ///
+    /// The angle is taken as reported by the lidar (angle_z_q14, clockwise when seen from the top),
+    /// so x = dist * cos(angle) and y = dist * sin(angle), both in millimeters.
+    /// The intensity is the node's quality field. Nodes with zero distance map to (0, 0).
+    /// The fastest implementation available on the running CPU is used: AVX2 with gathered table lookups,
+    /// SSE2 or NEON with scalar table lookups, or plain C++. All of them give the same result as polarToCartesianScalar().
+    ///
+    /// \param nodes      The input node buffer
+    /// \param count      The number of nodes to convert
+    /// \param x          The output buffer for x, must hold at least count elements
+    /// \param y          The output buffer for y, must hold at least count elements
+    /// \param intensity  The output buffer for the intensity, must hold at least count elements, can be NULL
+    void polarToCartesian(const sl_lidar_response_measurement_node_hq_t* nodes, size_t count, float* x, float* y, float* intensity);
+
+    /// Same as polarToCartesian(), but always uses the portable scalar implementation
+    void polarToCartesianScalar(const sl_lidar_response_measurement_node_hq_t* nodes, size_t count, float* x, float* y, float* intensity);
+
+}}
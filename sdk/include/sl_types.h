@@ -78,6 +78,7 @@ typedef uint32_t sl_result;
 #define SL_RESULT_OPERATION_NOT_SUPPORT  (sl_result)(0x8004 | SL_RESULT_FAIL_BIT)
 #define SL_RESULT_FORMAT_NOT_SUPPORT     (sl_result)(0x8005 | SL_RESULT_FAIL_BIT)
 #define SL_RESULT_INSUFFICIENT_MEMORY    (sl_result)(0x8006 | SL_RESULT_FAIL_BIT)
+#define SL_RESULT_OPERATION_ABORTED      (sl_result)(0x8007 | SL_RESULT_FAIL_BIT)
 
 #define SL_IS_OK(x)    ( ((x) & SL_RESULT_FAIL_BIT) == 0 )
 #define SL_IS_FAIL(x)  ( ((x) & SL_RESULT_FAIL_BIT) )
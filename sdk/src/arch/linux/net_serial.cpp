@@ -46,7 +46,9 @@
 #include <time.h>
 #include "hal/types.h"
 #include "arch/linux/net_serial.h"
-#include <sys/select.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <limits.h>
 
 #include <algorithm>
 //__GNUC__
@@ -55,6 +57,7 @@
 #include <asm/ioctls.h>
 #include <asm/termbits.h>
 #include <sys/ioctl.h>
+#include <linux/serial.h>
 extern "C" int tcflush(int fildes, int queue_selector);
 #else
 // for other standard UNIX
@@ -140,7 +143,8 @@ bool raw_serial::open(const char * portname, uint32_t baudrate, uint32_t flags)
     // raw output mode   
     options.c_oflag &= ~OPOST;
 
-
+    options.c_cc[VMIN] = _vmin;
+    options.c_cc[VTIME] = _vtime;
 
     if (tcsetattr(serial_fd, TCSANOW, &options))
     {
@@ -170,8 +174,8 @@ bool raw_serial::open(const char * portname, uint32_t baudrate, uint32_t flags)
     tio.c_iflag &= ~(IXON | IXOFF | IXANY); // no sw flow control
 
 
-    tio.c_cc[VMIN] = 0;         //min chars to read
-    tio.c_cc[VTIME] = 0;        //time in 1/10th sec wait
+    tio.c_cc[VMIN] = _vmin;     //min chars to read
+    tio.c_cc[VTIME] = _vtime;   //time in 1/10th sec wait
 
     tio.c_lflag &= ~(ICANON | ECHO | ECHOE | ISIG);
     // raw output mode   
@@ -183,6 +187,10 @@ bool raw_serial::open(const char * portname, uint32_t baudrate, uint32_t flags)
 
     ioctl(serial_fd, TCSETS2, &tio);
 
+    if (flags & FLAG_LOW_LATENCY) {
+        _setlowlatency();
+    }
+
 #endif
 
 
@@ -200,28 +208,33 @@ bool raw_serial::open(const char * portname, uint32_t baudrate, uint32_t flags)
 
     //Clear the DTR bit to let the motor spin
     clearDTR();
-    do {
-        // create self pipeline for wait cancellation
-        if (pipe(_selfpipe) == -1) break;
-
-        int flags = fcntl(_selfpipe[0], F_GETFL);
-        if (flags == -1)
-            break;
 
-        flags |= O_NONBLOCK;                /* Make read end nonblocking */
-        if (fcntl(_selfpipe[0], F_SETFL, flags) == -1)
-            break;
+    // the eventfd is signaled to cancel the pending wait
+    _cancelfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    _epollfd = epoll_create1(EPOLL_CLOEXEC);
+    if (_cancelfd == -1 || _epollfd == -1)
+    {
+        close();
+        return false;
+    }
 
-        flags = fcntl(_selfpipe[1], F_GETFL);
-        if (flags == -1)
-            break;
+    struct epoll_event evt;
+    memset(&evt, 0, sizeof(evt));
+    evt.events = EPOLLIN;
+    evt.data.fd = serial_fd;
+    if (epoll_ctl(_epollfd, EPOLL_CTL_ADD, serial_fd, &evt) == -1)
+    {
+        close();
+        return false;
+    }
 
-        flags |= O_NONBLOCK;                /* Make write end nonblocking */
-        if (fcntl(_selfpipe[1], F_SETFL, flags) == -1)
-            break;
+    evt.data.fd = _cancelfd;
+    if (epoll_ctl(_epollfd, EPOLL_CTL_ADD, _cancelfd, &evt) == -1)
+    {
+        close();
+        return false;
+    }
 
-    } while (0);
-    
     return true;
 }
 
@@ -231,13 +244,13 @@ void raw_serial::close()
         ::close(serial_fd);
     serial_fd = -1;
     
-    if (_selfpipe[0] != -1)
-        ::close(_selfpipe[0]);
+    if (_epollfd != -1)
+        ::close(_epollfd);
 
-    if (_selfpipe[1] != -1)
-        ::close(_selfpipe[1]);
+    if (_cancelfd != -1)
+        ::close(_cancelfd);
 
-    _selfpipe[0] = _selfpipe[1] = -1;
+    _epollfd = _cancelfd = -1;
 
     _operation_aborted = false;
     _is_serial_opened = false;
@@ -297,94 +310,98 @@ int raw_serial::waitforrecv(_u32 timeout, size_t * returned_size)
     return 0;
 }
 
-int raw_serial::waitfordata(size_t data_count, _u32 timeout, size_t * returned_size)
+int raw_serial::_waitforreadable(_u32 timeout)
 {
-    size_t length = 0;
-    if (returned_size==NULL) returned_size=(size_t *)&length;
-    *returned_size = 0;
-
-    int max_fd;
-    fd_set input_set;
-    struct timeval timeout_val;
-
-    /* Initialize the input set */
-    FD_ZERO(&input_set);
-    FD_SET(serial_fd, &input_set);
-
-    if (_selfpipe[0] != -1)
-        FD_SET(_selfpipe[0], &input_set);
-
-    max_fd =  std::max<int>(serial_fd, _selfpipe[0]) + 1;
-
-    /* Initialize the timeout structure */
-    timeout_val.tv_sec = timeout / 1000;
-    timeout_val.tv_usec = (timeout % 1000) * 1000;
-
-    if ( isOpened() )
-    {
-        int nread;
+    struct epoll_event events[2];
+    int timeout_ms = (timeout == (_u32)-1) ? -1 : (int)std::min<_u32>(timeout, INT_MAX);
 
-        if ( ioctl(serial_fd, FIONREAD, &nread) == -1) return ANS_DEV_ERR;
-
-        *returned_size = nread;
-
-        if (*returned_size >= data_count)
-        {
-            return 0;
-        }
-    }
-
-    while ( isOpened() )
+    for (;;)
     {
-        /* Do the select */
-        int n = ::select(max_fd, &input_set, NULL, NULL, &timeout_val);
+        int n = ::epoll_wait(_epollfd, events, sizeof(events) / sizeof(events[0]), timeout_ms);
 
         if (n < 0)
         {
-            // select error
-            *returned_size =  0;
+            if (errno == EINTR) continue;
             return ANS_DEV_ERR;
         }
         else if (n == 0)
         {
-            // time out
-            *returned_size =0;
             return ANS_TIMEOUT;
         }
-        else
+
+        int ans = ANS_TIMEOUT;
+        for (int pos = 0; pos < n; ++pos)
         {
-            if (FD_ISSET(_selfpipe[0], &input_set)) {   
-                // require aborting the current operation
-                int ch;
-                for (;;) {                    
-                    if (::read(_selfpipe[0], &ch, 1) == -1) {
-                        break;
-                    }
-                    
-                }
-
-                // treat as  timeout
-                *returned_size = 0;
+            if (events[pos].data.fd == _cancelfd) {
+                // require aborting the current operation, treat as timeout
+                eventfd_t counter;
+                eventfd_read(_cancelfd, &counter);
                 return ANS_TIMEOUT;
             }
 
-            // data avaliable
-            assert (FD_ISSET(serial_fd, &input_set));
+            if (events[pos].events & (EPOLLERR | EPOLLHUP)) {
+                ans = ANS_DEV_ERR;
+            }
+            else if (ans != ANS_DEV_ERR) {
+                ans = ANS_OK;
+            }
+        }
+        return ans;
+    }
+}
 
+int raw_serial::waitfordata(size_t data_count, _u32 timeout, size_t * returned_size)
+{
+    size_t length = 0;
+    if (returned_size==NULL) returned_size=(size_t *)&length;
+    *returned_size = 0;
 
-            if ( ioctl(serial_fd, FIONREAD, returned_size) == -1) return ANS_DEV_ERR;
-            if (*returned_size >= data_count)
-            {
-                return 0;
-            }
+    const _u64 deadline = getms() + timeout;
+
+    while ( isOpened() )
+    {
+        int nread;
+        if ( ioctl(serial_fd, FIONREAD, &nread) == -1) return ANS_DEV_ERR;
+
+        if ((size_t)nread >= data_count)
+        {
+            *returned_size = nread;
+            return ANS_OK;
         }
-        
+
+        _u32 remaining = timeout;
+        if (timeout != (_u32)-1)
+        {
+            _u64 now = getms();
+            remaining = (now < deadline) ? (_u32)(deadline - now) : 0;
+        }
+
+        int ans = _waitforreadable(remaining);
+        if (ans != ANS_OK) return ans;
     }
 
-    *returned_size=0;
     return ANS_DEV_ERR;
 }
 
+int raw_serial::waitandrecv(unsigned char * data, size_t size, _u32 timeout)
+{
+    if ( !isOpened() ) return ANS_DEV_ERR;
+
+    int ans = _waitforreadable(timeout);
+    if (ans != ANS_OK) return ans;
+
+    // the port is non-blocking, take whatever the driver has queued so far
+    int rxSize = ::read(serial_fd, data, size);
+    if (rxSize == -1)
+    {
+        if (errno != EAGAIN && errno != EINTR) return ANS_DEV_ERR;
+        rxSize = 0;
+    }
+
+    required_rx_cnt = rxSize;
+    return rxSize;
+}
+
 size_t raw_serial::rxqueue_count()
 {
     if  ( !isOpened() ) return 0;
@@ -410,21 +427,41 @@ void raw_serial::clearDTR()
     ioctl(serial_fd, TIOCMBIC, &dtr_bit);
 }
 
+void raw_serial::setreadthreshold(_u8 vmin, _u8 vtime)
+{
+    _vmin = vmin;
+    _vtime = vtime;
+}
+
+void raw_serial::_setlowlatency()
+{
+#if defined(__GNUC__)
+    // USB-serial drivers batch the rx data with a latency timer (16ms for ftdi/cp210x) unless told otherwise.
+    // not every tty supports it (e.g. pty), which is not an error
+    struct serial_struct serinfo;
+    if (ioctl(serial_fd, TIOCGSERIAL, &serinfo) == -1) return;
+
+    serinfo.flags |= ASYNC_LOW_LATENCY;
+    ioctl(serial_fd, TIOCSSERIAL, &serinfo);
+#endif
+}
+
 void raw_serial::_init()
 {
     serial_fd = -1;  
     _portName[0] = 0;
+    _vmin = _vtime = 0;
     required_tx_cnt = required_rx_cnt = 0;
     _operation_aborted = false;
-    _selfpipe[0] = _selfpipe[1] = -1;
+    _epollfd = _cancelfd = -1;
 }
 
 void raw_serial::cancelOperation()
 {
     _operation_aborted = true;
-    if (_selfpipe[1] == -1) return;
+    if (_cancelfd == -1) return;
 
-    (int)::write(_selfpipe[1], "x", 1);
+    eventfd_write(_cancelfd, 1);
 }
 
 _u32 raw_serial::getTermBaudBitmap(_u32 baud)
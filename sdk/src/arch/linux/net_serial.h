@@ -54,6 +54,7 @@ public:
     virtual void flush( _u32 flags);
     
     virtual int waitfordata(size_t data_count,_u32 timeout = -1, size_t * returned_size = NULL);
+    virtual int waitandrecv(unsigned char * data, size_t size, _u32 timeout = -1);
 
     virtual int senddata(const unsigned char * data, size_t size);
     virtual int recvdata(unsigned char * data, size_t size);
@@ -70,20 +71,28 @@ public:
 
     virtual void cancelOperation();
 
+    virtual void setreadthreshold(_u8 vmin, _u8 vtime);
+
 protected:
     bool open(const char * portname, uint32_t baudrate, uint32_t flags = 0);
     void _init();
+    void _setlowlatency();
+    int  _waitforreadable(_u32 timeout);
 
     char _portName[200];
     uint32_t _baudrate;
     uint32_t _flags;
+    _u8      _vmin;
+    _u8      _vtime;
 
     int serial_fd;
 
     size_t required_tx_cnt;
     size_t required_rx_cnt;
 
-    int    _selfpipe[2];
+    // the serial port and the cancellation eventfd are waited on through one epoll set
+    int    _epollfd;
+    int    _cancelfd;
     bool   _operation_aborted;
 };
 
@@ -320,12 +320,49 @@ namespace rp { namespace arch { namespace net{
 
 using namespace rp::net;
 
+// SO_TIMESTAMPNS reports CLOCK_REALTIME while getus() is based on CLOCK_MONOTONIC,
+// convert by subtracting the age of the data from the current monotonic time
+static _u64 _rxTimestampToLocal_uS(const struct timespec & rxTime, const struct timespec & realtimeNow, _u64 localNow_uS)
+{
+    _s64 age_ns = (_s64)(realtimeNow.tv_sec - rxTime.tv_sec) * 1000000000LL + (realtimeNow.tv_nsec - rxTime.tv_nsec);
+    if (age_ns < 0) age_ns = 0;
+
+    _u64 age_us = (_u64)age_ns / 1000;
+    return age_us < localNow_uS ? localNow_uS - age_us : 0;
+}
+
+static bool _findRxTimestamp(struct msghdr * msg, struct timespec & rxTime)
+{
+#ifdef SO_TIMESTAMPNS
+    for (struct cmsghdr * cmsg = CMSG_FIRSTHDR(msg); cmsg; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+            memcpy(&rxTime, CMSG_DATA(cmsg), sizeof(rxTime));
+            return true;
+        }
+    }
+#endif
+    return false;
+}
+
+static u_result _setRxTimestampOption(int fd, bool enable)
+{
+#ifdef SO_TIMESTAMPNS
+    int enable_flag = enable ? 1 : 0;
+    int ans = ::setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, (char *)&enable_flag, sizeof(enable_flag));
+    return ans ? RESULT_OPERATION_FAIL : RESULT_OK;
+#else
+    return RESULT_OPERATION_NOT_SUPPORT;
+#endif
+}
+
 class _single_thread StreamSocketImpl : public StreamSocket
 {
 public:
 
     StreamSocketImpl(int fd)
         : _socket_fd(fd)
+        , _rx_timestamp_enabled(false)
+        , _last_rx_timestamp(0)
     {
         assert(fd>=0);
         int bool_true = 1;
@@ -461,7 +498,13 @@ public:
 
     virtual u_result recv(void *buf, size_t len, size_t & recv_len)
     {
-        size_t ans = ::recv( _socket_fd, buf, len, 0);
+        size_t ans;
+        if (_rx_timestamp_enabled) {
+            ans = _recvWithTimestamp(buf, len);
+        } else {
+            ans = ::recv( _socket_fd, buf, len, 0);
+        }
+
         if (ans == (size_t)-1) {
             recv_len = 0;  
 
@@ -483,6 +526,19 @@ public:
         }
     }
 
+    virtual u_result enableRxTimestamp(bool enable)
+    {
+        u_result ans = _setRxTimestampOption(_socket_fd, enable);
+        if (IS_OK(ans)) _rx_timestamp_enabled = enable;
+        _last_rx_timestamp = 0;
+        return ans;
+    }
+
+    virtual _u64 getLastRxTimestamp_uS()
+    {
+        return _last_rx_timestamp;
+    }
+
 #if 0
     virtual u_result recvNoWait(void *buf, size_t len, size_t & recv_len)
     {
@@ -599,7 +655,34 @@ public:
     }
 
 protected:
+    size_t _recvWithTimestamp(void * buf, size_t len)
+    {
+        char ctrl[CMSG_SPACE(sizeof(struct timespec))];
+        struct iovec iov;
+        struct msghdr msg;
+
+        iov.iov_base = buf;
+        iov.iov_len = len;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = ctrl;
+        msg.msg_controllen = sizeof(ctrl);
+
+        ssize_t ans = ::recvmsg(_socket_fd, &msg, 0);
+        if (ans > 0) {
+            struct timespec rxTime, realtimeNow;
+            if (_findRxTimestamp(&msg, rxTime)) {
+                clock_gettime(CLOCK_REALTIME, &realtimeNow);
+                _last_rx_timestamp = _rxTimestampToLocal_uS(rxTime, realtimeNow, getus());
+            }
+        }
+        return (size_t)ans;
+    }
+
     int  _socket_fd;
+    bool _rx_timestamp_enabled;
+    _u64 _last_rx_timestamp;
 
 
 };
@@ -609,12 +692,21 @@ class _single_thread DGramSocketImpl : public DGramSocket
 {
 public:
 
+    enum {
+        MAX_RECV_BATCH_COUNT = 64,
+    };
+
     DGramSocketImpl(int fd)
         : _socket_fd(fd)
+        , _drop_count(0)
     {
         assert(fd>=0);
         int bool_true = 1;
         ::setsockopt( _socket_fd, SOL_SOCKET, SO_REUSEADDR | SO_BROADCAST , (char *)&bool_true, sizeof(bool_true) );
+#ifdef SO_RXQ_OVFL
+        // attach the kernel drop counter to every received datagram
+        ::setsockopt( _socket_fd, SOL_SOCKET, SO_RXQ_OVFL, (char *)&bool_true, sizeof(bool_true) );
+#endif
         setTimeout(DEFAULT_SOCKET_TIMEOUT, SOCKET_DIR_BOTH);
     }
 
@@ -806,6 +898,88 @@ public:
 
     }
 
+    virtual u_result recvBatch(void * buf, size_t slotSize, size_t count, size_t * recv_lens, size_t & recv_count, _u64 * rx_timestamps_uS)
+    {
+        struct mmsghdr msgs[MAX_RECV_BATCH_COUNT];
+        struct iovec iovs[MAX_RECV_BATCH_COUNT];
+        char ctrls[MAX_RECV_BATCH_COUNT][CMSG_SPACE(sizeof(_u32)) + CMSG_SPACE(sizeof(struct timespec))];
+
+        recv_count = 0;
+        if (count > MAX_RECV_BATCH_COUNT) count = MAX_RECV_BATCH_COUNT;
+        if (!count) return RESULT_OK;
+
+        memset(msgs, 0, sizeof(msgs[0]) * count);
+        for (size_t pos = 0; pos < count; ++pos) {
+            iovs[pos].iov_base = reinterpret_cast<_u8 *>(buf) + pos * slotSize;
+            iovs[pos].iov_len = slotSize;
+            msgs[pos].msg_hdr.msg_iov = &iovs[pos];
+            msgs[pos].msg_hdr.msg_iovlen = 1;
+            msgs[pos].msg_hdr.msg_control = ctrls[pos];
+            msgs[pos].msg_hdr.msg_controllen = sizeof(ctrls[pos]);
+        }
+
+        int ans = ::recvmmsg(_socket_fd, msgs, (unsigned int)count, MSG_DONTWAIT, NULL);
+        if (ans == -1) {
+            switch (errno) {
+                case EAGAIN:
+#if EWOULDBLOCK!=EAGAIN
+                case EWOULDBLOCK:
+#endif
+                    return RESULT_OPERATION_TIMEOUT;
+                default:
+                    return RESULT_OPERATION_FAIL;
+            }
+        }
+
+        struct timespec realtimeNow;
+        _u64 localNow = 0;
+        if (rx_timestamps_uS) {
+            clock_gettime(CLOCK_REALTIME, &realtimeNow);
+            localNow = getus();
+        }
+
+        for (int pos = 0; pos < ans; ++pos) {
+            recv_lens[pos] = msgs[pos].msg_len;
+
+            if (rx_timestamps_uS) {
+                struct timespec rxTime;
+                rx_timestamps_uS[pos] = _findRxTimestamp(&msgs[pos].msg_hdr, rxTime) ? _rxTimestampToLocal_uS(rxTime, realtimeNow, localNow) : 0;
+            }
+
+            for (struct cmsghdr * cmsg = CMSG_FIRSTHDR(&msgs[pos].msg_hdr); cmsg; cmsg = CMSG_NXTHDR(&msgs[pos].msg_hdr, cmsg)) {
+#ifdef SO_RXQ_OVFL
+                if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL) {
+                    memcpy(&_drop_count, CMSG_DATA(cmsg), sizeof(_drop_count));
+                }
+#endif
+            }
+        }
+        recv_count = ans;
+        return RESULT_OK;
+    }
+
+    virtual u_result enableRxTimestamp(bool enable)
+    {
+        return _setRxTimestampOption(_socket_fd, enable);
+    }
+
+    virtual u_result setReceiveBufferSize(size_t size)
+    {
+        int buffer_size = (int)size;
+        int ans = ::setsockopt( _socket_fd, SOL_SOCKET, SO_RCVBUF, (char *)&buffer_size, sizeof(buffer_size) );
+        return ans ? RESULT_OPERATION_FAIL : RESULT_OK;
+    }
+
+    virtual u_result getDropCount(_u32 & count)
+    {
+#ifdef SO_RXQ_OVFL
+        count = _drop_count;
+        return RESULT_OK;
+#else
+        return RESULT_OPERATION_NOT_SUPPORT;
+#endif
+    }
+
 #if 0
     virtual u_result recvFromNoWait(void *buf, size_t len, size_t & recv_len, SocketAddress * sourceAddr)
     {
@@ -834,6 +1008,7 @@ public:
     
 protected:
     int  _socket_fd;
+    _u32 _drop_count;
 
 };
 
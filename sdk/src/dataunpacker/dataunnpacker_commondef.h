@@ -55,6 +55,15 @@
 
 #define CONF_NO_BOOST_CRC_SUPPORT
 
+// Define CONF_NO_FLOAT_IN_UNPACKER (e.g. make EXTRA_DEFS=-DCONF_NO_FLOAT_IN_UNPACKER) to make sure the
+// sample decoding stays in integer arithmetic: any use of float/double in the unpacker sources
+// becomes a compile error. Only effective with GCC compatible compilers.
+#if defined(CONF_NO_FLOAT_IN_UNPACKER) && defined(__GNUC__)
+#define DATAUNPACKER_FORBID_FLOAT()  _Pragma("GCC poison float double")
+#else
+#define DATAUNPACKER_FORBID_FLOAT()
+#endif
+
 #include "dataupacker_namespace.h"
 
 
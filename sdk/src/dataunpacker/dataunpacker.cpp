@@ -61,6 +61,8 @@
 #define  DEF_REGISTER_HANDLER_LIST
 
 
+DATAUNPACKER_FORBID_FLOAT()
+
 BEGIN_DATAUNPACKER_NS()
 
 
@@ -100,6 +102,7 @@ public:
 		, _enabled(false)
 		, _lastActiveAnsType(0)
 		, _lastActiveHandler(nullptr)
+		, _rxTimestamp_uS(0)
 	{
 
 	}
@@ -120,9 +123,11 @@ public:
 		}
 	}
 
-	virtual bool onSampleData(_u8 ansType, const void* buffer, size_t size) {
+	virtual bool onSampleData(_u8 ansType, const void* buffer, size_t size, _u64 rxTimestamp_uS) {
 		if (!_enabled) return false;
 
+		_rxTimestamp_uS = rxTimestamp_uS;
+
 
 		if (_lastActiveAnsType != ansType) {
 			onDeselectHandler();
@@ -175,7 +180,7 @@ public:
 	}
 
 	virtual _u64 getCurrentTimestamp_uS() {
-		return getus();
+		return _rxTimestamp_uS ? _rxTimestamp_uS : getus();
 	}
 
 	virtual void publishHQNode(_u64 timestamp_uS, const rplidar_response_measurement_node_hq_t* node)
@@ -183,6 +188,11 @@ public:
 		_listener.onHQNodeDecoded(timestamp_uS, node);
 	}
 
+	virtual void publishHQNodes(const rplidar_response_measurement_node_hq_t* nodes, const _u64* timestamp_uS, size_t count)
+	{
+		_listener.onHQNodesDecoded(nodes, timestamp_uS, count);
+	}
+
 
 	virtual void publishDecodingErrorMsg(int errorType, _u8 ansType, const void* payload, size_t size)
 	{
@@ -220,6 +230,7 @@ protected:
 
 	_u8 _lastActiveAnsType;
 	IDataUnpackerHandler* _lastActiveHandler;
+	_u64 _rxTimestamp_uS;
 };
 
 LIDARSampleDataUnpacker* LIDARSampleDataUnpacker::CreateInstance(LIDARSampleDataListener& listener)
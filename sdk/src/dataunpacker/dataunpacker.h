@@ -51,6 +51,11 @@ class LIDARSampleDataListener
 public:
 	virtual void onHQNodeScanResetReq() = 0;
 	virtual void onHQNodeDecoded(_u64 timestamp_uS, const rplidar_response_measurement_node_hq_t* node) = 0;
+	virtual void onHQNodesDecoded(const rplidar_response_measurement_node_hq_t* nodes, const _u64* timestamp_uS, size_t count) {
+		for (size_t pos = 0; pos < count; ++pos) {
+			onHQNodeDecoded(timestamp_uS[pos], nodes + pos);
+		}
+	}
 	virtual void onCustomSampleDataDecoded(_u8 ansType, _u32 customCode, const void* data, size_t size) {}
 
 	virtual void onDecodingError(int errMsg, _u8 ansType, const void* payload, size_t size) {}
@@ -80,7 +85,9 @@ public:
 	virtual void enable() = 0;
 	virtual void disable() = 0;
 
-	virtual bool onSampleData(_u8 ansType, const void* buffer, size_t size) = 0;
+	// rxTimestamp_uS: time when the data was received by the channel (in the getus() time base),
+	//                0 to stamp the samples with the current time
+	virtual bool onSampleData(_u8 ansType, const void* buffer, size_t size, _u64 rxTimestamp_uS = 0) = 0;
 	virtual void reset() = 0;
 	virtual void clearCache() = 0;
 
@@ -0,0 +1,374 @@
+/*
+ *  Slamtec LIDAR SDK
+ *
+ *  Copyright (c) 2014 - 2023 Shanghai Slamtec Co., Ltd.
+ *  http://www.slamtec.com
+ *
+ */
+
+ /*
+  *  Sample Data Unpacker System
+  *  Batched Decoding Kernels of the Capsule Style Sample Nodes
+  */
+
+  /*
+	* Redistribution and use in source and binary forms, with or without
+	* modification, are permitted provided that the following conditions are met:
+	*
+	* 1. Redistributions of source code must retain the above copyright notice,
+	*    this list of conditions and the following disclaimer.
+	*
+	* 2. Redistributions in binary form must reproduce the above copyright notice,
+	*    this list of conditions and the following disclaimer in the documentation
+	*    and/or other materials provided with the distribution.
+	*
+	* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+	* THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+	* PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+	* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+	* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+	* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+	* OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+	* WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+	* OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+	* EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+	*
+	*/
+
+#include "../dataunnpacker_commondef.h"
+#include "../dataunpacker.h"
+#include "../dataunnpacker_internal.h"
+
+#include "capsule_kernels.h"
+#include <string.h>
+
+// the vectorized paths write the packed hq nodes as pairs of little endian dwords
+#ifndef _CPU_ENDIAN_BIG
+
+#if (defined(__GNUC__) && defined(__SSE2__)) || (defined(_MSC_VER) && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+#   define DATAUNPACKER_HAS_SSE2
+#   include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#   define DATAUNPACKER_HAS_NEON
+#   include <arm_neon.h>
+#endif
+
+#endif
+
+DATAUNPACKER_FORBID_FLOAT()
+
+BEGIN_DATAUNPACKER_NS()
+
+namespace unpacker {
+
+#define DISTANCE_THRESHOLD_TO_SCALE_1 2046  // (2^10 - 1)*2 mm
+#define DISTANCE_THRESHOLD_TO_SCALE_2 8187  // (2^11 - 1)*3 + 2046 mm
+#define DISTANCE_THRESHOLD_TO_SCALE_3 24567 // (2^12 - 1)*4 + 8187 mm
+
+static const int CAPSULE_ANGLE_RANGE_Q16 = (360 << 16);
+static const int CAPSULE_ANGLE_RANGE_Q6 = (360 << 6);
+
+// x / 90 == (x * 11930465) >> 30 for 0 <= x < 2^25
+static const _u32 CAPSULE_DIV90_MAGIC = 11930465;
+static const int  CAPSULE_DIV90_SHIFT = 30;
+
+
+void packCapsuleSamplesScalar(rplidar_response_measurement_node_hq_t* nodes, const int* dist_q2, const _u8* quality, size_t count
+    , int startAngle_raw_q16, int angleInc_q16, int syncWindow_q16)
+{
+    int currentAngle_raw_q16 = startAngle_raw_q16;
+
+    for (size_t pos = 0; pos < count; ++pos)
+    {
+        int angle_q6 = (currentAngle_raw_q16 >> 10);
+        int syncBit = (((currentAngle_raw_q16 + angleInc_q16) % CAPSULE_ANGLE_RANGE_Q16) < syncWindow_q16) ? 1 : 0;
+
+        currentAngle_raw_q16 += angleInc_q16;
+
+        if (angle_q6 < 0) angle_q6 += CAPSULE_ANGLE_RANGE_Q6;
+        if (angle_q6 >= CAPSULE_ANGLE_RANGE_Q6) angle_q6 -= CAPSULE_ANGLE_RANGE_Q6;
+
+        rplidar_response_measurement_node_hq_t& hqNode = nodes[pos];
+
+        hqNode.flag = (syncBit | ((!syncBit) << 1));
+        hqNode.quality = quality[pos];
+        hqNode.angle_z_q14 = (angle_q6 << 8) / 90;
+        hqNode.dist_mm_q2 = dist_q2[pos];
+    }
+}
+
+void decodeUltraDenseSamplesScalar(int* dist_q2, _u8* quality, const _u32* qualityDistScale, size_t count)
+{
+    for (size_t pos = 0; pos < count; ++pos)
+    {
+        _u32 quality_dist_scale = qualityDistScale[pos];
+
+        switch (quality_dist_scale & 0x3) {
+        case 0:
+            quality[pos] = (_u8)(quality_dist_scale >> 12);
+            dist_q2[pos] = (quality_dist_scale & 0xFFC) * 2;
+            break;
+        case 1:
+            quality[pos] = (_u8)((quality_dist_scale >> 13) << 1);
+            dist_q2[pos] = (quality_dist_scale & 0x1FFC) * 3 + (DISTANCE_THRESHOLD_TO_SCALE_1 << 2);
+            break;
+        case 2:
+            quality[pos] = (_u8)((quality_dist_scale >> 14) << 2);
+            dist_q2[pos] = (quality_dist_scale & 0x3FFC) * 4 + (DISTANCE_THRESHOLD_TO_SCALE_2 << 2);
+            break;
+        case 3:
+            quality[pos] = (_u8)((quality_dist_scale >> 15) << 3);
+            dist_q2[pos] = (quality_dist_scale & 0x7FFC) * 5 + (DISTANCE_THRESHOLD_TO_SCALE_3 << 2);
+            break;
+        }
+    }
+}
+
+#if defined(DATAUNPACKER_HAS_SSE2) || defined(DATAUNPACKER_HAS_NEON)
+
+// The vectorized angle decoding wraps the sync angle with two conditional subtractions
+// and the sample angle with a single one, which only matches the % operator of the
+// scalar version when the angles stay non-negative and below 3 turns.
+static bool _canPackCapsuleSamplesVectorized(size_t count, int startAngle_raw_q16, int angleInc_q16)
+{
+    if (startAngle_raw_q16 < 0 || angleInc_q16 < 0) return false;
+    return ((_s64)startAngle_raw_q16 + (_s64)(count + 1) * angleInc_q16) < (_s64)CAPSULE_ANGLE_RANGE_Q16 * 3;
+}
+
+#endif
+
+#if defined(DATAUNPACKER_HAS_SSE2)
+
+static inline __m128i _mm_select_si128(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// (x * CAPSULE_DIV90_MAGIC) >> CAPSULE_DIV90_SHIFT of the 4 unsigned lanes
+static inline __m128i _mm_div90_epu32(__m128i x)
+{
+    const __m128i magic = _mm_set1_epi32((int)CAPSULE_DIV90_MAGIC);
+    __m128i even = _mm_srli_epi64(_mm_mul_epu32(x, magic), CAPSULE_DIV90_SHIFT);
+    __m128i odd = _mm_srli_epi64(_mm_mul_epu32(_mm_srli_epi64(x, 32), magic), CAPSULE_DIV90_SHIFT);
+    return _mm_or_si128(_mm_and_si128(even, _mm_set_epi32(0, -1, 0, -1)), _mm_slli_epi64(odd, 32));
+}
+
+void packCapsuleSamples(rplidar_response_measurement_node_hq_t* nodes, const int* dist_q2, const _u8* quality, size_t count
+    , int startAngle_raw_q16, int angleInc_q16, int syncWindow_q16)
+{
+    if (!_canPackCapsuleSamplesVectorized(count, startAngle_raw_q16, angleInc_q16)) {
+        packCapsuleSamplesScalar(nodes, dist_q2, quality, count, startAngle_raw_q16, angleInc_q16, syncWindow_q16);
+        return;
+    }
+
+    const __m128i range_q16 = _mm_set1_epi32(CAPSULE_ANGLE_RANGE_Q16);
+    const __m128i range_q6 = _mm_set1_epi32(CAPSULE_ANGLE_RANGE_Q6);
+    const __m128i inc = _mm_set1_epi32(angleInc_q16);
+    const __m128i step = _mm_set1_epi32(angleInc_q16 * 4);
+    const __m128i syncWindow = _mm_set1_epi32(syncWindow_q16);
+    const __m128i flagNoSync = _mm_set1_epi32(RPLIDAR_RESP_HQ_FLAG_SYNCBIT << 1);
+    const __m128i lowWord = _mm_set1_epi32(0xFFFF);
+
+    __m128i currentAngle_raw_q16 = _mm_add_epi32(_mm_set1_epi32(startAngle_raw_q16)
+        , _mm_set_epi32(angleInc_q16 * 3, angleInc_q16 * 2, angleInc_q16, 0));
+
+    size_t pos = 0;
+    for (; pos + 4 <= count; pos += 4)
+    {
+        __m128i angle_q6 = _mm_srai_epi32(currentAngle_raw_q16, 10);
+        angle_q6 = _mm_select_si128(_mm_cmpgt_epi32(range_q6, angle_q6), angle_q6, _mm_sub_epi32(angle_q6, range_q6));
+
+        __m128i syncAngle_q16 = _mm_add_epi32(currentAngle_raw_q16, inc);
+        syncAngle_q16 = _mm_select_si128(_mm_cmpgt_epi32(range_q16, syncAngle_q16), syncAngle_q16, _mm_sub_epi32(syncAngle_q16, range_q16));
+        syncAngle_q16 = _mm_select_si128(_mm_cmpgt_epi32(range_q16, syncAngle_q16), syncAngle_q16, _mm_sub_epi32(syncAngle_q16, range_q16));
+
+        // 1 for the sync samples, 2 otherwise
+        __m128i flag = _mm_add_epi32(flagNoSync, _mm_cmpgt_epi32(syncWindow, syncAngle_q16));
+        __m128i angle_z_q14 = _mm_and_si128(_mm_div90_epu32(_mm_slli_epi32(angle_q6, 8)), lowWord);
+
+        __m128i dist = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dist_q2 + pos));
+        int qualityWord;
+        memcpy(&qualityWord, quality + pos, sizeof(qualityWord));
+        __m128i qual = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(qualityWord), _mm_setzero_si128()), _mm_setzero_si128());
+
+        // node layout: angle_z_q14:16 dist_mm_q2:32 quality:8 flag:8
+        __m128i lo = _mm_or_si128(angle_z_q14, _mm_slli_epi32(dist, 16));
+        __m128i hi = _mm_or_si128(_mm_srli_epi32(dist, 16), _mm_or_si128(_mm_slli_epi32(qual, 16), _mm_slli_epi32(flag, 24)));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(nodes + pos), _mm_unpacklo_epi32(lo, hi));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(nodes + pos + 2), _mm_unpackhi_epi32(lo, hi));
+
+        currentAngle_raw_q16 = _mm_add_epi32(currentAngle_raw_q16, step);
+    }
+
+    packCapsuleSamplesScalar(nodes + pos, dist_q2 + pos, quality + pos, count - pos
+        , startAngle_raw_q16 + (int)pos * angleInc_q16, angleInc_q16, syncWindow_q16);
+}
+
+void decodeUltraDenseSamples(int* dist_q2, _u8* quality, const _u32* qualityDistScale, size_t count)
+{
+    const __m128i scaleMask = _mm_set1_epi32(0x3);
+
+    size_t pos = 0;
+    for (; pos + 4 <= count; pos += 4)
+    {
+        __m128i qds = _mm_loadu_si128(reinterpret_cast<const __m128i*>(qualityDistScale + pos));
+        __m128i scale = _mm_and_si128(qds, scaleMask);
+
+        __m128i dist0 = _mm_slli_epi32(_mm_and_si128(qds, _mm_set1_epi32(0xFFC)), 1);
+        __m128i dist1 = _mm_and_si128(qds, _mm_set1_epi32(0x1FFC));
+        dist1 = _mm_add_epi32(_mm_add_epi32(dist1, _mm_slli_epi32(dist1, 1)), _mm_set1_epi32(DISTANCE_THRESHOLD_TO_SCALE_1 << 2));
+        __m128i dist2 = _mm_add_epi32(_mm_slli_epi32(_mm_and_si128(qds, _mm_set1_epi32(0x3FFC)), 2), _mm_set1_epi32(DISTANCE_THRESHOLD_TO_SCALE_2 << 2));
+        __m128i dist3 = _mm_and_si128(qds, _mm_set1_epi32(0x7FFC));
+        dist3 = _mm_add_epi32(_mm_add_epi32(dist3, _mm_slli_epi32(dist3, 2)), _mm_set1_epi32(DISTANCE_THRESHOLD_TO_SCALE_3 << 2));
+
+        __m128i qual0 = _mm_srli_epi32(qds, 12);
+        __m128i qual1 = _mm_slli_epi32(_mm_srli_epi32(qds, 13), 1);
+        __m128i qual2 = _mm_slli_epi32(_mm_srli_epi32(qds, 14), 2);
+        __m128i qual3 = _mm_slli_epi32(_mm_srli_epi32(qds, 15), 3);
+
+        __m128i isScale1 = _mm_cmpeq_epi32(scale, _mm_set1_epi32(1));
+        __m128i isScale2 = _mm_cmpeq_epi32(scale, _mm_set1_epi32(2));
+        __m128i isScale3 = _mm_cmpeq_epi32(scale, scaleMask);
+
+        __m128i dist = _mm_select_si128(isScale1, dist1, dist0);
+        dist = _mm_select_si128(isScale2, dist2, dist);
+        dist = _mm_select_si128(isScale3, dist3, dist);
+
+        __m128i qual = _mm_select_si128(isScale1, qual1, qual0);
+        qual = _mm_select_si128(isScale2, qual2, qual);
+        qual = _mm_select_si128(isScale3, qual3, qual);
+        qual = _mm_and_si128(qual, _mm_set1_epi32(0xFF));
+        qual = _mm_packus_epi16(_mm_packs_epi32(qual, qual), _mm_setzero_si128());
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dist_q2 + pos), dist);
+        int qualityWord = _mm_cvtsi128_si32(qual);
+        memcpy(quality + pos, &qualityWord, sizeof(qualityWord));
+    }
+
+    decodeUltraDenseSamplesScalar(dist_q2 + pos, quality + pos, qualityDistScale + pos, count - pos);
+}
+
+#elif defined(DATAUNPACKER_HAS_NEON)
+
+// (x * CAPSULE_DIV90_MAGIC) >> CAPSULE_DIV90_SHIFT of the 4 unsigned lanes
+static inline uint32x4_t _neon_div90_u32(uint32x4_t x)
+{
+    const uint32x2_t magic = vdup_n_u32(CAPSULE_DIV90_MAGIC);
+    uint32x2_t lo = vshrn_n_u64(vmull_u32(vget_low_u32(x), magic), CAPSULE_DIV90_SHIFT);
+    uint32x2_t hi = vshrn_n_u64(vmull_u32(vget_high_u32(x), magic), CAPSULE_DIV90_SHIFT);
+    return vcombine_u32(lo, hi);
+}
+
+void packCapsuleSamples(rplidar_response_measurement_node_hq_t* nodes, const int* dist_q2, const _u8* quality, size_t count
+    , int startAngle_raw_q16, int angleInc_q16, int syncWindow_q16)
+{
+    if (!_canPackCapsuleSamplesVectorized(count, startAngle_raw_q16, angleInc_q16)) {
+        packCapsuleSamplesScalar(nodes, dist_q2, quality, count, startAngle_raw_q16, angleInc_q16, syncWindow_q16);
+        return;
+    }
+
+    const int32x4_t range_q16 = vdupq_n_s32(CAPSULE_ANGLE_RANGE_Q16);
+    const int32x4_t range_q6 = vdupq_n_s32(CAPSULE_ANGLE_RANGE_Q6);
+    const int32x4_t inc = vdupq_n_s32(angleInc_q16);
+    const int32x4_t step = vdupq_n_s32(angleInc_q16 * 4);
+    const int32x4_t syncWindow = vdupq_n_s32(syncWindow_q16);
+    const uint32x4_t flagNoSync = vdupq_n_u32(RPLIDAR_RESP_HQ_FLAG_SYNCBIT << 1);
+    const uint32x4_t lowWord = vdupq_n_u32(0xFFFF);
+    const int laneOffsets[4] = { 0, angleInc_q16, angleInc_q16 * 2, angleInc_q16 * 3 };
+
+    int32x4_t currentAngle_raw_q16 = vaddq_s32(vdupq_n_s32(startAngle_raw_q16), vld1q_s32(laneOffsets));
+
+    size_t pos = 0;
+    for (; pos + 4 <= count; pos += 4)
+    {
+        int32x4_t angle_q6 = vshrq_n_s32(currentAngle_raw_q16, 10);
+        angle_q6 = vsubq_s32(angle_q6, vandq_s32(vreinterpretq_s32_u32(vcgeq_s32(angle_q6, range_q6)), range_q6));
+
+        int32x4_t syncAngle_q16 = vaddq_s32(currentAngle_raw_q16, inc);
+        syncAngle_q16 = vsubq_s32(syncAngle_q16, vandq_s32(vreinterpretq_s32_u32(vcgeq_s32(syncAngle_q16, range_q16)), range_q16));
+        syncAngle_q16 = vsubq_s32(syncAngle_q16, vandq_s32(vreinterpretq_s32_u32(vcgeq_s32(syncAngle_q16, range_q16)), range_q16));
+
+        // 1 for the sync samples, 2 otherwise
+        uint32x4_t flag = vaddq_u32(flagNoSync, vcltq_s32(syncAngle_q16, syncWindow));
+        uint32x4_t angle_z_q14 = vandq_u32(_neon_div90_u32(vreinterpretq_u32_s32(vshlq_n_s32(angle_q6, 8))), lowWord);
+
+        uint32x4_t dist = vreinterpretq_u32_s32(vld1q_s32(dist_q2 + pos));
+        _u32 qualityWord;
+        memcpy(&qualityWord, quality + pos, sizeof(qualityWord));
+        uint32x4_t qual = vmovl_u16(vget_low_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(qualityWord)))));
+
+        // node layout: angle_z_q14:16 dist_mm_q2:32 quality:8 flag:8
+        uint32x4_t lo = vorrq_u32(angle_z_q14, vshlq_n_u32(dist, 16));
+        uint32x4_t hi = vorrq_u32(vshrq_n_u32(dist, 16), vorrq_u32(vshlq_n_u32(qual, 16), vshlq_n_u32(flag, 24)));
+
+        uint32x4x2_t packed = vzipq_u32(lo, hi);
+        vst1q_u8(reinterpret_cast<uint8_t*>(nodes + pos), vreinterpretq_u8_u32(packed.val[0]));
+        vst1q_u8(reinterpret_cast<uint8_t*>(nodes + pos + 2), vreinterpretq_u8_u32(packed.val[1]));
+
+        currentAngle_raw_q16 = vaddq_s32(currentAngle_raw_q16, step);
+    }
+
+    packCapsuleSamplesScalar(nodes + pos, dist_q2 + pos, quality + pos, count - pos
+        , startAngle_raw_q16 + (int)pos * angleInc_q16, angleInc_q16, syncWindow_q16);
+}
+
+void decodeUltraDenseSamples(int* dist_q2, _u8* quality, const _u32* qualityDistScale, size_t count)
+{
+    size_t pos = 0;
+    for (; pos + 4 <= count; pos += 4)
+    {
+        uint32x4_t qds = vld1q_u32(qualityDistScale + pos);
+        uint32x4_t scale = vandq_u32(qds, vdupq_n_u32(0x3));
+
+        uint32x4_t dist0 = vshlq_n_u32(vandq_u32(qds, vdupq_n_u32(0xFFC)), 1);
+        uint32x4_t dist1 = vmlaq_n_u32(vdupq_n_u32(DISTANCE_THRESHOLD_TO_SCALE_1 << 2), vandq_u32(qds, vdupq_n_u32(0x1FFC)), 3);
+        uint32x4_t dist2 = vmlaq_n_u32(vdupq_n_u32(DISTANCE_THRESHOLD_TO_SCALE_2 << 2), vandq_u32(qds, vdupq_n_u32(0x3FFC)), 4);
+        uint32x4_t dist3 = vmlaq_n_u32(vdupq_n_u32(DISTANCE_THRESHOLD_TO_SCALE_3 << 2), vandq_u32(qds, vdupq_n_u32(0x7FFC)), 5);
+
+        uint32x4_t qual0 = vshrq_n_u32(qds, 12);
+        uint32x4_t qual1 = vshlq_n_u32(vshrq_n_u32(qds, 13), 1);
+        uint32x4_t qual2 = vshlq_n_u32(vshrq_n_u32(qds, 14), 2);
+        uint32x4_t qual3 = vshlq_n_u32(vshrq_n_u32(qds, 15), 3);
+
+        uint32x4_t isScale1 = vceqq_u32(scale, vdupq_n_u32(1));
+        uint32x4_t isScale2 = vceqq_u32(scale, vdupq_n_u32(2));
+        uint32x4_t isScale3 = vceqq_u32(scale, vdupq_n_u32(3));
+
+        uint32x4_t dist = vbslq_u32(isScale1, dist1, dist0);
+        dist = vbslq_u32(isScale2, dist2, dist);
+        dist = vbslq_u32(isScale3, dist3, dist);
+
+        uint32x4_t qual = vbslq_u32(isScale1, qual1, qual0);
+        qual = vbslq_u32(isScale2, qual2, qual);
+        qual = vbslq_u32(isScale3, qual3, qual);
+
+        vst1q_s32(dist_q2 + pos, vreinterpretq_s32_u32(dist));
+        uint16x4_t qual16 = vmovn_u32(qual);
+        uint8x8_t qual8 = vmovn_u16(vcombine_u16(qual16, qual16));
+        _u32 qualityWord = vget_lane_u32(vreinterpret_u32_u8(qual8), 0);
+        memcpy(quality + pos, &qualityWord, sizeof(qualityWord));
+    }
+
+    decodeUltraDenseSamplesScalar(dist_q2 + pos, quality + pos, qualityDistScale + pos, count - pos);
+}
+
+#else
+
+void packCapsuleSamples(rplidar_response_measurement_node_hq_t* nodes, const int* dist_q2, const _u8* quality, size_t count
+    , int startAngle_raw_q16, int angleInc_q16, int syncWindow_q16)
+{
+    packCapsuleSamplesScalar(nodes, dist_q2, quality, count, startAngle_raw_q16, angleInc_q16, syncWindow_q16);
+}
+
+void decodeUltraDenseSamples(int* dist_q2, _u8* quality, const _u32* qualityDistScale, size_t count)
+{
+    decodeUltraDenseSamplesScalar(dist_q2, quality, qualityDistScale, count);
+}
+
+#endif
+
+}
+
+END_DATAUNPACKER_NS()
@@ -0,0 +1,68 @@
+/*
+ *  Slamtec LIDAR SDK
+ *
+ *  Copyright (c) 2014 - 2023 Shanghai Slamtec Co., Ltd.
+ *  http://www.slamtec.com
+ *
+ */
+
+ /*
+  *  Sample Data Unpacker System
+  *  Batched Decoding Kernels of the Capsule Style Sample Nodes
+  */
+
+  /*
+	* Redistribution and use in source and binary forms, with or without
+	* modification, are permitted provided that the following conditions are met:
+	*
+	* 1. Redistributions of source code must retain the above copyright notice,
+	*    this list of conditions and the following disclaimer.
+	*
+	* 2. Redistributions in binary form must reproduce the above copyright notice,
+	*    this list of conditions and the following disclaimer in the documentation
+	*    and/or other materials provided with the distribution.
+	*
+	* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+	* THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+	* PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+	* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+	* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+	* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+	* OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+	* WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+	* OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+	* EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+	*
+	*/
+
+#pragma once
+
+BEGIN_DATAUNPACKER_NS()
+
+namespace unpacker {
+
+// The kernels below decode a whole capsule at once, using SSE2 or NEON when
+// available. The results are bit-exact to the *Scalar reference versions.
+//
+// The parts of the decoding that depend on the previous sample (the sync bit
+// de-duplication, the distance smoothing of the ultra dense mode) are left
+// to the caller as a serial pass over the output.
+
+// Packs count evenly spaced samples into hq nodes.
+// The sample idx is at angle (startAngle_raw_q16 + idx * angleInc_q16) >> 10 (q6),
+// wrapped once into [0, 360) degrees, and its flag carries the raw sync bit, set
+// when ((startAngle_raw_q16 + (idx + 1) * angleInc_q16) % (360 << 16)) < syncWindow_q16.
+void packCapsuleSamples(rplidar_response_measurement_node_hq_t* nodes, const int* dist_q2, const _u8* quality, size_t count
+	, int startAngle_raw_q16, int angleInc_q16, int syncWindow_q16);
+void packCapsuleSamplesScalar(rplidar_response_measurement_node_hq_t* nodes, const int* dist_q2, const _u8* quality, size_t count
+	, int startAngle_raw_q16, int angleInc_q16, int syncWindow_q16);
+
+// Decodes the 20bit quality-distance-scale words of the ultra dense capsules.
+// The distance smoothing of the scale 0 samples is not applied.
+void decodeUltraDenseSamples(int* dist_q2, _u8* quality, const _u32* qualityDistScale, size_t count);
+void decodeUltraDenseSamplesScalar(int* dist_q2, _u8* quality, const _u32* qualityDistScale, size_t count);
+
+}
+
+END_DATAUNPACKER_NS()
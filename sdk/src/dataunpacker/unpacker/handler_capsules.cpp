@@ -43,6 +43,9 @@
 
 
 #include "handler_capsules.h"
+#include "capsule_kernels.h"
+
+DATAUNPACKER_FORBID_FLOAT()
 
 BEGIN_DATAUNPACKER_NS()
 	
@@ -218,6 +221,10 @@ void UnpackerHandler_CapsuleNode::_onScanNodeCapsuleData(rplidar_response_capsul
 
         int angleInc_q16 = (diffAngle_q8 << 3);
         int currentAngle_raw_q16 = (prevStartAngle_q8 << 8);
+
+        rplidar_response_measurement_node_hq_t hqNodes[_countof(_cached_previous_capsuledata.cabins) * 2];
+        _u64 hqNodeTimestamps[_countof(hqNodes)];
+
         for (int pos = 0; pos < (int)_countof(_cached_previous_capsuledata.cabins); ++pos)
         {
             int dist_q2[2];
@@ -244,7 +251,7 @@ void UnpackerHandler_CapsuleNode::_onScanNodeCapsuleData(rplidar_response_capsul
                 if (angle_q6[cpos] < 0) angle_q6[cpos] += (360 << 6);
                 if (angle_q6[cpos] >= (360 << 6)) angle_q6[cpos] -= (360 << 6);
 
-                rplidar_response_measurement_node_hq_t hqNode;
+                rplidar_response_measurement_node_hq_t& hqNode = hqNodes[pos * 2 + cpos];
 
 
                 hqNode.flag = (syncBit[cpos] | ((!syncBit[cpos]) << 1));
@@ -253,10 +260,12 @@ void UnpackerHandler_CapsuleNode::_onScanNodeCapsuleData(rplidar_response_capsul
                 hqNode.angle_z_q14 = (angle_q6[cpos] << 8) / 90;
                 hqNode.dist_mm_q2 = dist_q2[cpos];
 
-                engine->publishHQNode(_cached_last_data_timestamp_us - _getSampleDelayOffsetInExpressMode(_cachedTimingDesc, pos * 2 + cpos), &hqNode);
+                hqNodeTimestamps[pos * 2 + cpos] = _cached_last_data_timestamp_us - _getSampleDelayOffsetInExpressMode(_cachedTimingDesc, pos * 2 + cpos);
             }
 
         }
+
+        engine->publishHQNodes(hqNodes, hqNodeTimestamps, _countof(hqNodes));
     }
 
     _cached_previous_capsuledata = capsule;
@@ -457,6 +466,69 @@ static _u32 _varbitscale_decode(_u32 scaled, _u32& scaleLevel)
     return 0;
 }
 
+// The angle offset of the ultra capsule samples is evaluated in radians and converted back to degrees.
+// Everything is kept in integer math so the decoding does not need an FPU, the results are identical
+// to the floating point reference formula.
+
+// pi as used by the reference formula, scaled by 1e10
+static constexpr _u64 ULTRA_OFFSET_PI_E10 = 31415926535ULL;
+
+// (int)(deg_x10 / 10 * pi * (1 << 16) / 180)
+static constexpr int _ultraOffsetDegToRad_q16(_u64 deg_x10)
+{
+    return (int)(deg_x10 * ULTRA_OFFSET_PI_E10 * (1 << 16) / (1800ULL * 10000000000ULL));
+}
+
+static constexpr int ULTRA_OFFSET_ANGLE_MEAN_DEFAULT_Q16 = _ultraOffsetDegToRad_q16(75); // 7.5 degrees
+static constexpr int ULTRA_OFFSET_ANGLE_MEAN_BASE_Q16 = _ultraOffsetDegToRad_q16(80);    // 8 degrees
+
+static_assert(ULTRA_OFFSET_ANGLE_MEAN_DEFAULT_Q16 == 8578, "unexpected ultra capsule offset angle");
+static_assert(ULTRA_OFFSET_ANGLE_MEAN_BASE_Q16 == 9150, "unexpected ultra capsule offset angle");
+
+// 180 / 3.14159265 in q28, rounded
+static constexpr _u64 ULTRA_OFFSET_RAD_TO_DEG_Q28 = (18000000000ULL * (1ULL << 28) + 314159265ULL / 2) / 314159265ULL;
+
+// (int)(rad_q16 * 180 / 3.14159265), exact for |rad_q16| < 40000, the offsets stay within [-23478, 9150]
+static constexpr int _ultraOffsetRadToDeg_q16(int rad_q16)
+{
+    return rad_q16 < 0 ? -(int)(((_u64)-rad_q16 * ULTRA_OFFSET_RAD_TO_DEG_Q28) >> 28)
+        : (int)(((_u64)rad_q16 * ULTRA_OFFSET_RAD_TO_DEG_Q28) >> 28);
+}
+
+// The offset only depends on k2 = K1 / dist_q2 for samples farther than 50mm,
+// so the final offset in degrees is looked up from a table built at compile time.
+static constexpr int ULTRA_OFFSET_MIN_DIST_Q2 = 50 * 4;
+static constexpr int ULTRA_OFFSET_K1 = 98361;
+static constexpr int ULTRA_OFFSET_MAX_K2 = ULTRA_OFFSET_K1 / ULTRA_OFFSET_MIN_DIST_Q2;
+
+static constexpr int _ultraOffsetDeg_q16(int k2)
+{
+    return _ultraOffsetRadToDeg_q16(ULTRA_OFFSET_ANGLE_MEAN_BASE_Q16 - (k2 << 6) - (k2 * k2 * k2) / 98304);
+}
+
+template <int... Is> struct _ultra_index_list {};
+template <int N, int... Is> struct _make_ultra_index_list : _make_ultra_index_list<N - 1, N - 1, Is...> {};
+template <int... Is> struct _make_ultra_index_list<0, Is...> { typedef _ultra_index_list<Is...> type; };
+
+struct UltraOffsetTable {
+    int deg_q16[ULTRA_OFFSET_MAX_K2 + 1];
+};
+
+template <int... Is>
+static constexpr UltraOffsetTable _makeUltraOffsetTable(_ultra_index_list<Is...>)
+{
+    return UltraOffsetTable{ { _ultraOffsetDeg_q16(Is)... } };
+}
+
+static constexpr UltraOffsetTable ULTRA_OFFSET_TABLE = _makeUltraOffsetTable(_make_ultra_index_list<ULTRA_OFFSET_MAX_K2 + 1>::type());
+static constexpr int ULTRA_OFFSET_DEFAULT_DEG_Q16 = _ultraOffsetRadToDeg_q16(ULTRA_OFFSET_ANGLE_MEAN_DEFAULT_Q16);
+
+static inline int _getUltraOffsetDeg_q16(int dist_q2)
+{
+    if (dist_q2 < ULTRA_OFFSET_MIN_DIST_Q2) return ULTRA_OFFSET_DEFAULT_DEG_Q16;
+    return ULTRA_OFFSET_TABLE.deg_q16[ULTRA_OFFSET_K1 / dist_q2];
+}
+
 void UnpackerHandler_UltraCapsuleNode::_onScanNodeUltraCapsuleData(rplidar_response_ultra_capsule_measurement_nodes_t& capsule, LIDARSampleDataUnpackerInner* engine)
 {
     _u64 currentTS = engine->getCurrentTimestamp_uS();
@@ -471,13 +543,15 @@ void UnpackerHandler_UltraCapsuleNode::_onScanNodeUltraCapsuleData(rplidar_respo
         }
 
         int angleInc_q16 = (diffAngle_q8 << 3) / 3;
-        int currentAngle_raw_q16 = (prevStartAngle_q8 << 8);
+        int startAngle_raw_q16 = (prevStartAngle_q8 << 8);
+
+        rplidar_response_measurement_node_hq_t hqNodes[_countof(_cached_previous_ultracapsuledata.ultra_cabins) * 3];
+        _u64 hqNodeTimestamps[_countof(hqNodes)];
+        int dist_q2[_countof(hqNodes)];
+
+        // pass 1: the distances of the whole capsule
         for (int pos = 0; pos < (int)_countof(_cached_previous_ultracapsuledata.ultra_cabins); ++pos)
         {
-            int dist_q2[3];
-            int angle_q6[3];
-            int syncBit[3];
-
 
             _u32 combined_x3 = _cached_previous_ultracapsuledata.ultra_cabins[pos].combined_x3;
 
@@ -517,60 +591,49 @@ void UnpackerHandler_UltraCapsuleNode::_onScanNodeUltraCapsuleData(rplidar_respo
             }
 
 
-            dist_q2[0] = (dist_major << 2);
+            int* cabinDist_q2 = dist_q2 + pos * 3;
+            cabinDist_q2[0] = (dist_major << 2);
             if (((_u32)dist_predict1 == 0xFFFFFE00) || ((_u32)dist_predict1 == 0x1FF)) {
-                dist_q2[1] = 0;
+                cabinDist_q2[1] = 0;
             }
             else {
                 dist_predict1 = (int)(dist_predict1 << scalelvl1);
-                dist_q2[1] = (dist_predict1 + dist_base1) << 2;
+                cabinDist_q2[1] = (dist_predict1 + dist_base1) << 2;
 
             }
 
             if (((_u32)dist_predict2 == 0xFFFFFE00) || ((_u32)dist_predict2 == 0x1FF)) {
-                dist_q2[2] = 0;
+                cabinDist_q2[2] = 0;
             }
             else {
                 dist_predict2 = (int)(dist_predict2 << scalelvl2);
-                dist_q2[2] = (dist_predict2 + dist_base2) << 2;
+                cabinDist_q2[2] = (dist_predict2 + dist_base2) << 2;
             }
+        }
 
-            for (int cpos = 0; cpos < 3; ++cpos)
-            {
-
-                syncBit[cpos] = (((currentAngle_raw_q16 + angleInc_q16) % (360 << 16)) < angleInc_q16) ? 1 : 0;
-
-
-                rplidar_response_measurement_node_hq_t hqNode;
-
-
-                int offsetAngleMean_q16 = (int)(7.5 * 3.1415926535 * (1 << 16) / 180.0);
-
-                if (dist_q2[cpos] >= (50 * 4))
-                {
-                    const int k1 = 98361;
-                    const int k2 = int(k1 / dist_q2[cpos]);
-
-                    offsetAngleMean_q16 = (int)(8 * 3.1415926535 * (1 << 16) / 180) - (k2 << 6) - (k2 * k2 * k2) / 98304;
-                }
-
-                angle_q6[cpos] = ((currentAngle_raw_q16 - int(offsetAngleMean_q16 * 180 / 3.14159265)) >> 10);
-                currentAngle_raw_q16 += angleInc_q16;
-
-                if (angle_q6[cpos] < 0) angle_q6[cpos] += (360 << 6);
-                if (angle_q6[cpos] >= (360 << 6)) angle_q6[cpos] -= (360 << 6);
-
+        // pass 2: the angles and the sample info, the samples of the capsule are evenly spaced
+        const _u64 lastSampleDelay = _getSampleDelayOffsetInUltraBoostMode(_cachedTimingDesc, _countof(hqNodes) - 1);
 
-                hqNode.flag = (syncBit[cpos] | ((!syncBit[cpos]) << 1));
-                hqNode.quality = dist_q2[cpos] ? (0x2F << RPLIDAR_RESP_MEASUREMENT_QUALITY_SHIFT) : 0;
+        for (int pos = 0; pos < (int)_countof(hqNodes); ++pos)
+        {
+            int currentAngle_raw_q16 = startAngle_raw_q16 + pos * angleInc_q16;
+            int syncBit = (((currentAngle_raw_q16 + angleInc_q16) % (360 << 16)) < angleInc_q16) ? 1 : 0;
 
-                hqNode.angle_z_q14 = (angle_q6[cpos] << 8) / 90;
-                hqNode.dist_mm_q2 = dist_q2[cpos];
+            int angle_q6 = ((currentAngle_raw_q16 - _getUltraOffsetDeg_q16(dist_q2[pos])) >> 10);
+            if (angle_q6 < 0) angle_q6 += (360 << 6);
+            if (angle_q6 >= (360 << 6)) angle_q6 -= (360 << 6);
 
-                engine->publishHQNode(_cached_last_data_timestamp_us - _getSampleDelayOffsetInUltraBoostMode(_cachedTimingDesc, pos * 3 + cpos), &hqNode);
-            }
+            rplidar_response_measurement_node_hq_t& hqNode = hqNodes[pos];
+            hqNode.flag = (syncBit | ((!syncBit) << 1));
+            hqNode.quality = dist_q2[pos] ? (0x2F << RPLIDAR_RESP_MEASUREMENT_QUALITY_SHIFT) : 0;
+            hqNode.angle_z_q14 = (angle_q6 << 8) / 90;
+            hqNode.dist_mm_q2 = dist_q2[pos];
 
+            // same as _getSampleDelayOffsetInUltraBoostMode(pos), the grouping delay shrinks by one sample duration per sample
+            hqNodeTimestamps[pos] = _cached_last_data_timestamp_us - (lastSampleDelay + (_u64)((_countof(hqNodes) - 1) - pos) * _cachedTimingDesc.sample_duration_uS);
         }
+
+        engine->publishHQNodes(hqNodes, hqNodeTimestamps, _countof(hqNodes));
     }
 
     _cached_previous_ultracapsuledata = capsule;
@@ -610,6 +673,7 @@ UnpackerHandler_DenseCapsuleNode::UnpackerHandler_DenseCapsuleNode()
     : _cached_scan_node_buf_pos(0)
     , _is_previous_capsuledataRdy(false)
     , _cached_last_data_timestamp_us(0)
+    , _last_node_sync_bit(0)
 
 {
     _cached_scan_node_buf.resize(sizeof(rplidar_response_dense_capsule_measurement_nodes_t));
@@ -731,11 +795,11 @@ void UnpackerHandler_DenseCapsuleNode::reset()
 {
     _cached_scan_node_buf_pos = 0;
     _cached_last_data_timestamp_us = 0;
+    _last_node_sync_bit = 0;
 }
 
 void UnpackerHandler_DenseCapsuleNode::_onScanNodeDenseCapsuleData(rplidar_response_dense_capsule_measurement_nodes_t& dense_capsule, LIDARSampleDataUnpackerInner* engine)
 {
-    static int lastNodeSyncBit = 0;
     _u64 currentTs = engine->getCurrentTimestamp_uS();
 
     if (_is_previous_capsuledataRdy) {
@@ -754,35 +818,36 @@ void UnpackerHandler_DenseCapsuleNode::_onScanNodeDenseCapsuleData(rplidar_respo
         }
 
         int angleInc_q16 = (diffAngle_q8 << 8) / 40;
-        int currentAngle_raw_q16 = (prevStartAngle_q8 << 8);
-        for (int pos = 0; pos < (int)_countof(_cached_previous_dense_capsuledata.cabins); ++pos)
-        {
-            int dist_q2;
-            int angle_q6;
-            int syncBit;
-            const int dist = static_cast<const int>(_cached_previous_dense_capsuledata.cabins[pos].distance);
-            dist_q2 = dist << 2;
-            angle_q6 = (currentAngle_raw_q16 >> 10);
-            syncBit = (((currentAngle_raw_q16 + angleInc_q16) % (360 << 16)) < (angleInc_q16 << 1)) ? 1 : 0;
-            syncBit = (syncBit ^ lastNodeSyncBit) & syncBit;//Ensure that syncBit is exactly detected
 
-            currentAngle_raw_q16 += angleInc_q16;
+        rplidar_response_measurement_node_hq_t hqNodes[_countof(_cached_previous_dense_capsuledata.cabins)];
+        _u64 hqNodeTimestamps[_countof(hqNodes)];
+        int dist_q2[_countof(hqNodes)];
+        _u8 quality[_countof(hqNodes)];
 
-            if (angle_q6 < 0) angle_q6 += (360 << 6);
-            if (angle_q6 >= (360 << 6)) angle_q6 -= (360 << 6);
+        for (int pos = 0; pos < (int)_countof(hqNodes); ++pos)
+        {
+            dist_q2[pos] = static_cast<const int>(_cached_previous_dense_capsuledata.cabins[pos].distance) << 2;
+            quality[pos] = dist_q2[pos] ? (0x2F << RPLIDAR_RESP_MEASUREMENT_QUALITY_SHIFT) : 0;
+        }
+
+        packCapsuleSamples(hqNodes, dist_q2, quality, _countof(hqNodes), (prevStartAngle_q8 << 8), angleInc_q16, (angleInc_q16 << 1));
 
-            rplidar_response_measurement_node_hq_t hqNode;
+        const _u64 lastSampleDelay = _getSampleDelayOffsetInDenseMode(_cachedTimingDesc, _countof(hqNodes) - 1);
 
+        for (int pos = 0; pos < (int)_countof(hqNodes); ++pos)
+        {
+            rplidar_response_measurement_node_hq_t& hqNode = hqNodes[pos];
 
+            int syncBit = (hqNode.flag & RPLIDAR_RESP_HQ_FLAG_SYNCBIT);
+            syncBit = (syncBit ^ _last_node_sync_bit) & syncBit;//Ensure that syncBit is exactly detected
             hqNode.flag = (syncBit | ((!syncBit) << 1));
-            hqNode.quality = dist_q2 ? (0x2F << RPLIDAR_RESP_MEASUREMENT_QUALITY_SHIFT) : 0;
-            hqNode.angle_z_q14 = (angle_q6 << 8) / 90;
-            hqNode.dist_mm_q2 = dist_q2;
-            engine->publishHQNode(currentTs - _getSampleDelayOffsetInDenseMode(_cachedTimingDesc, pos), &hqNode);
-            
-            lastNodeSyncBit = syncBit;
+            _last_node_sync_bit = syncBit;
 
+            // same as _getSampleDelayOffsetInDenseMode(pos)
+            hqNodeTimestamps[pos] = currentTs - (lastSampleDelay + (_u64)((_countof(hqNodes) - 1) - pos) * _cachedTimingDesc.sample_duration_uS);
         }
+
+        engine->publishHQNodes(hqNodes, hqNodeTimestamps, _countof(hqNodes));
     }
 
     _cached_previous_dense_capsuledata = dense_capsule;
@@ -970,75 +1035,52 @@ void UnpackerHandler_UltraDenseCapsuleNode::_onScanNodeUltraDenseCapsuleData(rpl
             _cached_previous_ultra_dense_capsuledata = *ultra_dense_capsule;
             return;
         }
-#define DISTANCE_THRESHOLD_TO_SCALE_1 2046  // (2^10 - 1)*2 mm
-#define DISTANCE_THRESHOLD_TO_SCALE_2 8187  // (2^11 - 1)*3 + 2046 mm
-#define DISTANCE_THRESHOLD_TO_SCALE_3 24567 // (2^12 - 1)*4 + 8187 mm
         int angleInc_q16 = (diffAngle_q8 << 8) / 64;
-        int currentAngle_raw_q16 = (prevStartAngle_q8 << 8);
-        for (int pos = 0; pos < (int)_countof(_cached_previous_ultra_dense_capsuledata.cabins) * 2; ++pos)
-        {
-            int angle_q6;
-            int syncBit;
-            size_t cabin_idx = pos >> 1;
-            _u32  quality_dist_scale;
-            if (!(pos & 0x1)) {
-                quality_dist_scale = _cached_previous_ultra_dense_capsuledata.cabins[cabin_idx].qualityl_distance_scale[0] | ((_cached_previous_ultra_dense_capsuledata.cabins[cabin_idx].qualityh_array & 0x0F) << 16);
-            }
-            else {
-                quality_dist_scale = _cached_previous_ultra_dense_capsuledata.cabins[cabin_idx].qualityl_distance_scale[1] | ((_cached_previous_ultra_dense_capsuledata.cabins[cabin_idx].qualityh_array >> 4) << 16);
-            }
 
-            _u8 scale = quality_dist_scale & 0x3;
-            _u8 quality = 0;
-            int dist_q2 = 0;
-
-            switch (scale) {
-            case 0:
-                quality = quality_dist_scale >> 12;
-                dist_q2 = (quality_dist_scale & 0xFFC) * 2;
-                if (_last_dist_q2) {
-                    if (abs(dist_q2 - _last_dist_q2) <= 8/*2mm *2*/) {
-                        dist_q2 = (dist_q2 + _last_dist_q2) >> 1;
-                    }
-                }
-                break;
-            case 1:
-                quality = (quality_dist_scale >> 13) << 1;
-                dist_q2 = (quality_dist_scale & 0x1FFC) * 3 + (DISTANCE_THRESHOLD_TO_SCALE_1 << 2);
-                break;
-            case 2:
-                quality = (quality_dist_scale >> 14) << 2;
-                dist_q2 = (quality_dist_scale & 0x3FFC) * 4 + (DISTANCE_THRESHOLD_TO_SCALE_2 << 2);
-                break;
-            case 3:
-                quality = (quality_dist_scale >> 15) << 3;
-                dist_q2 = (quality_dist_scale & 0x7FFC) * 5 + (DISTANCE_THRESHOLD_TO_SCALE_3 << 2);
-                break;
-            }
-            _last_dist_q2 = dist_q2;
-            angle_q6 = (currentAngle_raw_q16 >> 10);
-            syncBit = (((currentAngle_raw_q16 + angleInc_q16) % (360 << 16)) < (angleInc_q16 << 1)) ? 1 : 0;
-            syncBit = (syncBit ^ _last_node_sync_bit) & syncBit;//Ensure that syncBit is exactly detected
+        rplidar_response_measurement_node_hq_t hqNodes[_countof(_cached_previous_ultra_dense_capsuledata.cabins) * 2];
+        _u64 hqNodeTimestamps[_countof(hqNodes)];
+        _u32 quality_dist_scale[_countof(hqNodes)];
+        int dist_q2[_countof(hqNodes)];
+        _u8 quality[_countof(hqNodes)];
 
-            currentAngle_raw_q16 += angleInc_q16;
+        for (int pos = 0; pos < (int)_countof(_cached_previous_ultra_dense_capsuledata.cabins); ++pos)
+        {
+            const sl_lidar_response_ultra_dense_cabin_nodes_t& cabin = _cached_previous_ultra_dense_capsuledata.cabins[pos];
+            quality_dist_scale[pos * 2] = cabin.qualityl_distance_scale[0] | ((cabin.qualityh_array & 0x0F) << 16);
+            quality_dist_scale[pos * 2 + 1] = cabin.qualityl_distance_scale[1] | ((cabin.qualityh_array >> 4) << 16);
+        }
 
-            if (angle_q6 < 0) angle_q6 += (360 << 6);
-            if (angle_q6 >= (360 << 6)) angle_q6 -= (360 << 6);
+        decodeUltraDenseSamples(dist_q2, quality, quality_dist_scale, _countof(hqNodes));
 
+        // the short range samples (scale 0) are smoothed with the previous sample
+        for (int pos = 0; pos < (int)_countof(hqNodes); ++pos)
+        {
+            if (!(quality_dist_scale[pos] & 0x3) && _last_dist_q2) {
+                if (abs(dist_q2[pos] - _last_dist_q2) <= 8/*2mm *2*/) {
+                    dist_q2[pos] = (dist_q2[pos] + _last_dist_q2) >> 1;
+                }
+            }
+            _last_dist_q2 = dist_q2[pos];
+        }
 
-            rplidar_response_measurement_node_hq_t hqNode;
+        packCapsuleSamples(hqNodes, dist_q2, quality, _countof(hqNodes), (prevStartAngle_q8 << 8), angleInc_q16, (angleInc_q16 << 1));
 
+        const _u64 lastSampleDelay = _getSampleDelayOffsetInUltraDenseMode(_cachedTimingDesc, _countof(hqNodes) - 1);
 
+        for (int pos = 0; pos < (int)_countof(hqNodes); ++pos)
+        {
+            rplidar_response_measurement_node_hq_t& hqNode = hqNodes[pos];
 
+            int syncBit = (hqNode.flag & RPLIDAR_RESP_HQ_FLAG_SYNCBIT);
+            syncBit = (syncBit ^ _last_node_sync_bit) & syncBit;//Ensure that syncBit is exactly detected
             hqNode.flag = (syncBit | ((!syncBit) << 1));
-            hqNode.quality = quality;
-            hqNode.angle_z_q14 = (angle_q6 << 8) / 90;
-            hqNode.dist_mm_q2 = dist_q2;
-            engine->publishHQNode(currentTimestamp - _getSampleDelayOffsetInUltraDenseMode(_cachedTimingDesc, pos), &hqNode);
-            
             _last_node_sync_bit = syncBit;
 
+            // same as _getSampleDelayOffsetInUltraDenseMode(pos)
+            hqNodeTimestamps[pos] = currentTimestamp - (lastSampleDelay + (_u64)((_countof(hqNodes) - 1) - pos) * _cachedTimingDesc.sample_duration_uS);
         }
+
+        engine->publishHQNodes(hqNodes, hqNodeTimestamps, _countof(hqNodes));
     }
 
     _cached_previous_ultra_dense_capsuledata = *ultra_dense_capsule;
@@ -111,6 +111,8 @@ protected:
 	rplidar_response_dense_capsule_measurement_nodes_t _cached_previous_dense_capsuledata;
 	_u64             _cached_last_data_timestamp_us;
 
+	int              _last_node_sync_bit;
+
 	SlamtecLidarTimingDesc _cachedTimingDesc;
 
 };
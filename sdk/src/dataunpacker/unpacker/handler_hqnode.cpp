@@ -46,6 +46,8 @@
 
 #include "handler_hqnode.h"
 
+DATAUNPACKER_FORBID_FLOAT()
+
 BEGIN_DATAUNPACKER_NS()
 	
 namespace unpacker{
@@ -147,15 +149,18 @@ void UnpackerHandler_HQNode::onData(LIDARSampleDataUnpackerInner* engine, const
 #endif
             if (recvCRC == crcCalc)
             {
+                _u64 hqNodeTimestamps[_countof(nodesData->node_hq)];
+                _u64 currentTs = engine->getCurrentTimestamp_uS() - _getSampleDelayOffsetInHQMode(_cachedTimingDesc);
+
                 for (size_t pos = 0; pos < _countof(nodesData->node_hq); ++pos)
                 {
-                    rplidar_response_measurement_node_hq_t hqNode = nodesData->node_hq[pos];
 #ifdef _CPU_ENDIAN_BIG
-                    hqNode.angle_z_q14 = le16_to_cpu(hqNode.angle_z_q14);
-                    hqNode.dist_mm_q2 = le32_to_cpu(hqNode.dist_mm_q2);
+                    nodesData->node_hq[pos].angle_z_q14 = le16_to_cpu(nodesData->node_hq[pos].angle_z_q14);
+                    nodesData->node_hq[pos].dist_mm_q2 = le32_to_cpu(nodesData->node_hq[pos].dist_mm_q2);
 #endif
-                    engine->publishHQNode(engine->getCurrentTimestamp_uS() - _getSampleDelayOffsetInHQMode(_cachedTimingDesc), &hqNode);
+                    hqNodeTimestamps[pos] = currentTs;
                 }
+                engine->publishHQNodes(nodesData->node_hq, hqNodeTimestamps, _countof(nodesData->node_hq));
             }
             else  //crc check not passed 
             {
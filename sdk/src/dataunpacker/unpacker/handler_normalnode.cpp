@@ -43,6 +43,8 @@
 
 #include "handler_normalnode.h"
 
+DATAUNPACKER_FORBID_FLOAT()
+
 BEGIN_DATAUNPACKER_NS()
 	
 namespace unpacker{
@@ -47,6 +47,11 @@ public:
         ANS_DEV_ERR = -2,
     };
 
+    // flags of bind()
+    enum {
+        FLAG_LOW_LATENCY = 0x1 << 0, // ask the driver to deliver the received data without batching it
+    };
+
     static serial_rxtx * CreateRxTx();
     static void ReleaseRxTx( serial_rxtx * );
 
@@ -61,6 +66,16 @@ public:
     
     virtual int waitfordata(size_t data_count,_u32 timeout = -1, size_t * returned_size = NULL) = 0;
 
+    // waits for incoming data and reads up to size bytes of what is available,
+    // returns the bytes read or ANS_TIMEOUT/ANS_DEV_ERR
+    virtual int waitandrecv(unsigned char * data, size_t size, _u32 timeout = -1)
+    {
+        size_t ready = 0;
+        int ans = waitfordata(1, timeout, &ready);
+        if (ans != ANS_OK) return ans;
+        return recvdata(data, ready < size ? ready : size);
+    }
+
     virtual int senddata(const unsigned char * data, size_t size) = 0;
     virtual int recvdata(unsigned char * data, size_t size) = 0;
 
@@ -73,6 +88,9 @@ public:
     virtual void clearDTR() = 0;
     virtual void cancelOperation() {}
 
+    // termios VMIN/VTIME of the port, applied by the next open() where supported
+    virtual void setreadthreshold(_u8 vmin, _u8 vtime) {}
+
     virtual bool isOpened()
     {
         return _is_serial_opened;
@@ -0,0 +1,289 @@
+/*
+ *  Slamtec LIDAR SDK
+ *
+ *  Copyright (c) 2014 - 2023 Shanghai Slamtec Co., Ltd.
+ *  http://www.slamtec.com
+ *
+ */
+ /*
+  * Redistribution and use in source and binary forms, with or without
+  * modification, are permitted provided that the following conditions are met:
+  *
+  * 1. Redistributions of source code must retain the above copyright notice,
+  *    this list of conditions and the following disclaimer.
+  *
+  * 2. Redistributions in binary form must reproduce the above copyright notice,
+  *    this list of conditions and the following disclaimer in the documentation
+  *    and/or other materials provided with the distribution.
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+  * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+  * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+  * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+  * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+  * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+  * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+  * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+  * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  */
+
+#pragma once
+
+#include "hal/types.h"
+#include <atomic>
+#include <new>
+#include <string.h>
+
+namespace rp{ namespace hal{
+
+// A fixed size, lock-free byte ring for exactly one producer thread and
+// exactly one consumer thread.
+//
+// The storage is allocated once (the capacity is rounded up to a power of 2)
+// and the read/write indices live on separate cache lines so the producer and
+// the consumer do not keep invalidating each other's line.
+//
+// The producer may write either in-place (writableSpan + commitWrite) or via
+// push(). The consumer reads in-place via readableSpan + commitRead.
+// resize() and reset() are NOT thread-safe and must only be called while
+// neither side is running.
+class SPSCByteRing
+{
+public:
+    enum {
+        CACHELINE_SIZE = 64,
+    };
+
+    SPSCByteRing(size_t capacity = 0)
+        : _buffer(NULL)
+        , _capacity(0)
+        , _mask(0)
+        , _head(0)
+        , _cachedTail(0)
+        , _tail(0)
+        , _cachedHead(0)
+        , _overflowCount(0)
+    {
+        if (capacity) resize(capacity);
+    }
+
+    ~SPSCByteRing()
+    {
+        delete [] _buffer;
+    }
+
+    bool resize(size_t capacity)
+    {
+        size_t actualSize = 1;
+        while (actualSize < capacity) actualSize <<= 1;
+
+        _u8 * newBuffer = new (std::nothrow) _u8[actualSize];
+        if (!newBuffer) return false;
+
+        delete [] _buffer;
+        _buffer = newBuffer;
+        _capacity = actualSize;
+        _mask = actualSize - 1;
+        reset();
+        return true;
+    }
+
+    void reset()
+    {
+        _head.store(0, std::memory_order_relaxed);
+        _tail.store(0, std::memory_order_relaxed);
+        _cachedTail = 0;
+        _cachedHead = 0;
+        _overflowCount.store(0, std::memory_order_relaxed);
+    }
+
+    size_t capacity() const
+    {
+        return _capacity;
+    }
+
+    // number of bytes dropped by the producer since the last reset
+    size_t getOverflowCount() const
+    {
+        return _overflowCount.load(std::memory_order_relaxed);
+    }
+
+    void markOverflow(size_t droppedSize)
+    {
+        _overflowCount.fetch_add(droppedSize, std::memory_order_relaxed);
+    }
+
+    // --- producer side ---
+
+    // returns the size of the contiguous free region starting at the write position
+    size_t writableSpan(_u8 ** ptr)
+    {
+        size_t head = _head.load(std::memory_order_relaxed);
+        size_t freeSize = _capacity - (head - _cachedTail);
+        if (!freeSize) {
+            _cachedTail = _tail.load(std::memory_order_acquire);
+            freeSize = _capacity - (head - _cachedTail);
+        }
+
+        size_t offset = head & _mask;
+        size_t toEnd = _capacity - offset;
+
+        *ptr = _buffer + offset;
+        return freeSize < toEnd ? freeSize : toEnd;
+    }
+
+    size_t freeSize()
+    {
+        _cachedTail = _tail.load(std::memory_order_acquire);
+        return _capacity - (_head.load(std::memory_order_relaxed) - _cachedTail);
+    }
+
+    // total number of bytes written since the last reset (wraps around)
+    size_t writePosition() const
+    {
+        return _head.load(std::memory_order_relaxed);
+    }
+
+    void commitWrite(size_t size)
+    {
+        _head.store(_head.load(std::memory_order_relaxed) + size, std::memory_order_release);
+    }
+
+    // all-or-nothing copy into the ring, returns false if there is not enough room
+    bool push(const void * data, size_t size)
+    {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (_capacity - (head - _cachedTail) < size) {
+            _cachedTail = _tail.load(std::memory_order_acquire);
+            if (_capacity - (head - _cachedTail) < size) return false;
+        }
+
+        size_t offset = head & _mask;
+        size_t firstPart = _capacity - offset;
+        if (firstPart > size) firstPart = size;
+
+        memcpy(_buffer + offset, data, firstPart);
+        memcpy(_buffer, (const _u8 *)data + firstPart, size - firstPart);
+
+        _head.store(head + size, std::memory_order_release);
+        return true;
+    }
+
+    // --- consumer side ---
+
+    // returns the size of the contiguous filled region starting at the read position
+    size_t readableSpan(const _u8 ** ptr)
+    {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        size_t usedSize = _cachedHead - tail;
+        if (!usedSize) {
+            _cachedHead = _head.load(std::memory_order_acquire);
+            usedSize = _cachedHead - tail;
+        }
+
+        size_t offset = tail & _mask;
+        size_t toEnd = _capacity - offset;
+
+        *ptr = _buffer + offset;
+        return usedSize < toEnd ? usedSize : toEnd;
+    }
+
+    bool empty()
+    {
+        _cachedHead = _head.load(std::memory_order_acquire);
+        return _cachedHead == _tail.load(std::memory_order_relaxed);
+    }
+
+    // total number of bytes consumed since the last reset (wraps around)
+    size_t readPosition() const
+    {
+        return _tail.load(std::memory_order_relaxed);
+    }
+
+    void commitRead(size_t size)
+    {
+        _tail.store(_tail.load(std::memory_order_relaxed) + size, std::memory_order_release);
+    }
+
+protected:
+    _u8 *                 _buffer;
+    size_t                _capacity;
+    size_t                _mask;
+
+    char                  _pad0[CACHELINE_SIZE];
+
+    // written by the producer only
+    std::atomic<size_t>   _head;
+    size_t                _cachedTail;
+    char                  _pad1[CACHELINE_SIZE - sizeof(size_t) * 2];
+
+    // written by the consumer only
+    std::atomic<size_t>   _tail;
+    size_t                _cachedHead;
+    char                  _pad2[CACHELINE_SIZE - sizeof(size_t) * 2];
+
+    std::atomic<size_t>   _overflowCount;
+};
+
+
+// A fixed size, lock-free queue of small records for exactly one producer
+// thread and exactly one consumer thread. Capacity must be a power of 2.
+// reset() is NOT thread-safe, same as SPSCByteRing.
+template <class T, size_t Capacity>
+class SPSCFixedQueue
+{
+public:
+    static_assert((Capacity & (Capacity - 1)) == 0, "capacity must be a power of 2");
+
+    SPSCFixedQueue()
+        : _head(0)
+        , _tail(0)
+    {
+    }
+
+    void reset()
+    {
+        _head.store(0, std::memory_order_relaxed);
+        _tail.store(0, std::memory_order_relaxed);
+    }
+
+    // --- producer side ---
+
+    // returns false if the queue is full
+    bool push(const T & item)
+    {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) == Capacity) return false;
+
+        _items[head & (Capacity - 1)] = item;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // --- consumer side ---
+
+    // returns false if the queue is empty
+    bool front(T & item)
+    {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (_head.load(std::memory_order_acquire) == tail) return false;
+
+        item = _items[tail & (Capacity - 1)];
+        return true;
+    }
+
+    void pop()
+    {
+        _tail.store(_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+protected:
+    T                     _items[Capacity];
+    std::atomic<size_t>   _head;
+    std::atomic<size_t>   _tail;
+};
+
+}}
@@ -90,6 +90,10 @@ public:
 
     virtual u_result waitforSent(_u32 timeout  = DEFAULT_SOCKET_TIMEOUT) = 0;
     virtual u_result waitforData(_u32 timeout  = DEFAULT_SOCKET_TIMEOUT)  = 0;
+
+    // ask the kernel to timestamp the incoming data when it arrives
+    // the timestamps are converted to the getus() time base
+    virtual u_result enableRxTimestamp(bool enable = true) { return RESULT_OPERATION_NOT_SUPPORT; }
 protected:
     SocketBase() {} 
 };
@@ -114,6 +118,9 @@ public:
     virtual u_result send(const void * buffer, size_t len) = 0;
     
     virtual u_result recv(void *buf, size_t len, size_t & recv_len) = 0;
+
+    // receive timestamp of the data returned by the last recv(), 0 if not available
+    virtual _u64 getLastRxTimestamp_uS() { return 0; }
     
     virtual u_result getPeerAddress(SocketAddress & ) = 0;
 
@@ -139,6 +146,28 @@ public:
     virtual u_result sendTo(const SocketAddress * target, const void * buffer, size_t len) = 0;
     virtual u_result recvFrom(void *buf, size_t len, size_t & recv_len, SocketAddress * sourceAddr = NULL) = 0;
     virtual u_result clearRxCache() = 0;
+
+    // receives up to count pending datagrams, the datagram i is stored at buf + i * slotSize
+    // platforms without a batched receive take a single datagram per call
+    // rx_timestamps_uS (optional) receives the timestamp of each datagram, 0 if not available
+    virtual u_result recvBatch(void * buf, size_t slotSize, size_t count, size_t * recv_lens, size_t & recv_count, _u64 * rx_timestamps_uS = NULL)
+    {
+        recv_count = 0;
+        if (!count) return RESULT_OK;
+
+        u_result ans = recvFrom(buf, slotSize, recv_lens[0]);
+        if (IS_OK(ans)) {
+            recv_count = 1;
+            if (rx_timestamps_uS) rx_timestamps_uS[0] = 0;
+        }
+        return ans;
+    }
+
+    // kernel receive buffer size (SO_RCVBUF)
+    virtual u_result setReceiveBufferSize(size_t size) { return RESULT_OPERATION_NOT_SUPPORT; }
+
+    // datagrams dropped by the kernel because the receive buffer was full, as of the last recvBatch()
+    virtual u_result getDropCount(_u32 & count) { return RESULT_OPERATION_NOT_SUPPORT; }
     
 protected:
     virtual ~DGramSocket() {} // use dispose();
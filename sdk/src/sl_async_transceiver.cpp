@@ -176,12 +176,16 @@ void ProtocolMessage::_changeBufSize( bool force_compact)
 }
 
 
-AsyncTransceiver::AsyncTransceiver(IAsyncProtocolCodec& codec)
+AsyncTransceiver::AsyncTransceiver(IAsyncProtocolCodec& codec, size_t rxBufferSize)
 	: _bindedChannel(NULL)
 	, _codec(codec)
 	, _isWorking(false)
     , _workingFlag(0)
+    , _rxRing(rxBufferSize)
+    , _decoderWaiting(false)
+    , _decodingRxTimestamp(0)
 {
+    _rxBounceBuffer.resize(RX_BOUNCE_BUFFER_SIZE);
 
 }
 
@@ -190,7 +194,7 @@ AsyncTransceiver::~AsyncTransceiver()
     unbindAndClose();
 }
 
-u_result AsyncTransceiver::openChannelAndBind(IChannel* channel)
+u_result AsyncTransceiver::openChannelAndBind(IChannel* channel, _u32 bindFlags)
 {
     if (!channel) return RESULT_INVALID_DATA;
 
@@ -213,14 +217,23 @@ u_result AsyncTransceiver::openChannelAndBind(IChannel* channel)
         channel->flush();
 
 		_dataEvt.set(false);
+        _rxRing.reset();
+        _rxTimestampMarks.reset();
+        _decodingRxTimestamp = 0;
+        _decoderWaiting = false;
 
 		_isWorking = true;
         _workingFlag = 0;
         _bindedChannel = channel;
 
 
-		_decoderThread = CLASS_THREAD(AsyncTransceiver, _proc_decoderThread);
-		_rxThread = CLASS_THREAD(AsyncTransceiver, _proc_rxThread);
+        if (bindFlags & BIND_FLAG_SINGLE_THREAD) {
+            _rxThread = CLASS_THREAD(AsyncTransceiver, _proc_rxDecodeThread);
+        }
+        else {
+            _decoderThread = CLASS_THREAD(AsyncTransceiver, _proc_decoderThread);
+            _rxThread = CLASS_THREAD(AsyncTransceiver, _proc_rxThread);
+        }
 
         
 
@@ -250,11 +263,8 @@ void AsyncTransceiver::unbindAndClose()
     _bindedChannel = NULL;
 
 
-    for (std::list< Buffer* >::iterator itr = _rxQueue.begin(); itr != _rxQueue.end(); ++itr)
-    {
-        delete [] *itr;
-    }
-    _rxQueue.clear();
+    _rxRing.reset();
+    _rxTimestampMarks.reset();
 
 }
 
@@ -303,10 +313,22 @@ sl_result AsyncTransceiver::_proc_rxThread()
     rp::hal::Thread::SetSelfPriority(rp::hal::Thread::PRIORITY_HIGH);
 
     u_result result;
-    size_t hintedSize = 0;
     while (_isWorking)
     {
-        result = _bindedChannel->waitForDataExt(hintedSize, 1000);
+        _u8* rxBuffer;
+        size_t rxCapacity = _rxRing.writableSpan(&rxBuffer);
+        bool useBounceBuffer = false;
+        if (rxCapacity < _rxBounceBuffer.size())
+        {
+            // not enough contiguous room in the ring (wrapped or nearly full),
+            // the data must still be drained from the channel anyway
+            rxBuffer = &_rxBounceBuffer[0];
+            rxCapacity = _rxBounceBuffer.size();
+            useBounceBuffer = true;
+        }
+
+        size_t rxSize = 0;
+        result = _bindedChannel->waitAndRead(rxBuffer, rxCapacity, rxSize, 1000);
 
         if (IS_FAIL(result))
         {
@@ -317,53 +339,112 @@ sl_result AsyncTransceiver::_proc_rxThread()
             if (_isWorking) {
                 _workingFlag |= WORKING_FLAG_ERROR;
                 _codec.onChannelError(result);
-                break;
             }
+            break;
         }
 
-        // no data in buffer, sleep and wait for the next round
-        if (!hintedSize)
+        // no data in buffer, wait for the next round
+        if (!rxSize)
         {
             continue;
         }
 
+#ifdef _DEBUG_DUMP_PACKET
+        printf("Revc: %d\n", (int)rxSize);
+#endif
+
+        assert(rxCapacity >= rxSize);
 
-        Buffer* decodeBuffer = new Buffer();
-        
-        decodeBuffer->data = new _u8[hintedSize];
 
-        decodeBuffer->size = _bindedChannel->read(decodeBuffer->data, hintedSize);
 #ifdef _DEBUG_DUMP_PACKET
-        printf("Revc: %d\n", decodeBuffer->size);
+        printf("=== Dump RX Packet, size = %d ===\n", (int)rxSize);
+        for (size_t pos = 0; pos < rxSize; pos++)
+        {
+            printf("%02x ", rxBuffer[pos]);
+        }
+        printf("\n=== END ===\n");
 #endif
-         
-        if  (!decodeBuffer->size) {
-            delete decodeBuffer;
 
-            
-            _workingFlag |= WORKING_FLAG_ERROR;
-            _codec.onChannelError(RESULT_OPERATION_ABORTED);
-            break;
+        if (useBounceBuffer && _rxRing.freeSize() < rxSize) {
+            // the decoder is falling behind, drop the data
+            _rxRing.markOverflow(rxSize);
+            continue;
         }
 
-        assert(hintedSize >= decodeBuffer->size);
+        // the mark is published before the data so the decoder never sees the data without it
+        _u64 rxTimestamp = _bindedChannel->getLastReadTimestamp_uS();
+        if (rxTimestamp) {
+            RxTimestampMark mark;
+            mark.endPos = _rxRing.writePosition() + rxSize;
+            mark.timestamp_uS = rxTimestamp;
+            // when the marks run out, the following data shares the timestamp of the next mark
+            _rxTimestampMarks.push(mark);
+        }
+
+        if (useBounceBuffer) {
+            _rxRing.push(rxBuffer, rxSize);
+        }
+        else {
+            _rxRing.commitWrite(rxSize);
+        }
+
+        // pairs with the fence in _proc_decoderThread: either the decoder sees
+        // the new data, or we see it is about to sleep and wake it up
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_decoderWaiting.load(std::memory_order_relaxed)) {
+            _dataEvt.set();
+        }
+    }
+    _workingFlag |= WORKING_FLAG_RX_DISABLED;
+    return RESULT_OK;
+}
+
+sl_result AsyncTransceiver::_proc_rxDecodeThread()
+{
+    assert(_bindedChannel);
+
+    rp::hal::Thread::SetSelfPriority(rp::hal::Thread::PRIORITY_HIGH);
+    _codec.onDecodeReset();
+
+    // the ring is not involved, the data is decoded straight from the read buffer
+    _u8* rxBuffer = &_rxBounceBuffer[0];
+    size_t rxCapacity = _rxBounceBuffer.size();
+
+    u_result result;
+    while (_isWorking)
+    {
+        size_t rxSize = 0;
+        result = _bindedChannel->waitAndRead(rxBuffer, rxCapacity, rxSize, 1000);
 
+        if (IS_FAIL(result))
+        {
+            // timeout is allowed
+            if (result == RESULT_OPERATION_TIMEOUT) {
+                continue;
+            }
+            if (_isWorking) {
+                _workingFlag |= WORKING_FLAG_ERROR;
+                _codec.onChannelError(result);
+            }
+            break;
+        }
+
+        if (!rxSize)
+        {
+            continue;
+        }
 
 #ifdef _DEBUG_DUMP_PACKET
-        printf("=== Dump RX Packet, size = %d ===\n", decodeBuffer->size);
-        for (int pos = 0; pos < decodeBuffer->size; pos++)
+        printf("=== Dump RX Packet, size = %d ===\n", (int)rxSize);
+        for (size_t pos = 0; pos < rxSize; pos++)
         {
-            printf("%02x ", decodeBuffer->data[pos]);
+            printf("%02x ", rxBuffer[pos]);
         }
         printf("\n=== END ===\n");
 #endif
 
-        _rxLocker.lock();
-        _rxQueue.push_back(decodeBuffer);
-        _dataEvt.set();
-        _rxLocker.unlock();
-
-
+        _decodingRxTimestamp = _bindedChannel->getLastReadTimestamp_uS();
+        _codec.onDecodeData(rxBuffer, rxSize);
     }
     _workingFlag |= WORKING_FLAG_RX_DISABLED;
     return RESULT_OK;
@@ -379,29 +460,41 @@ sl_result AsyncTransceiver::_proc_decoderThread()
 
     while (_isWorking)
     {
-        _rxLocker.lock();
+        const _u8* data;
+        size_t size = _rxRing.readableSpan(&data);
 
-        if (_rxQueue.empty())
+        if (!size)
         {
-            _rxLocker.unlock();
-
-            if (_dataEvt.wait(1000))
-                continue;
+            _decoderWaiting.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
 
-            _rxLocker.lock();
+            if (_rxRing.empty()) {
+                _dataEvt.wait(1000);
+            }
+            _decoderWaiting.store(false, std::memory_order_relaxed);
+            continue;
         }
-        assert(!_rxQueue.empty());
-
-        Buffer * bufferToDecode = _rxQueue.front();
-        _rxQueue.pop_front();
-
-        _rxLocker.unlock();
 
-        //cout<<"decoding "<< bufferToDecode->size <<" bytes of data"<<endl;
-        _codec.onDecodeData(bufferToDecode->data, bufferToDecode->size);
+        // decode at most up to the end of the oldest read still in the ring,
+        // so the codec sees the receive timestamp of the data it is decoding
+        _decodingRxTimestamp = 0;
+        RxTimestampMark mark;
+        while (_rxTimestampMarks.front(mark)) {
+            size_t markedSize = mark.endPos - _rxRing.readPosition();
+            if (!markedSize || markedSize > _rxRing.capacity()) {
+                // already decoded
+                _rxTimestampMarks.pop();
+                continue;
+            }
 
+            if (markedSize < size) size = markedSize;
+            _decodingRxTimestamp = mark.timestamp_uS;
+            break;
+        }
 
-        delete bufferToDecode;
+        //cout<<"decoding "<< size <<" bytes of data"<<endl;
+        _codec.onDecodeData(data, size);
+        _rxRing.commitRead(size);
     }
 
     return RESULT_OK;
@@ -32,8 +32,11 @@
 
 #pragma once
 
-#include <list>
+#include <atomic>
 #include <memory>
+#include <vector>
+
+#include "hal/ringbuffer.h"
 
 namespace sl { namespace internal {
 
@@ -59,6 +62,7 @@ public:
 	void setDataBuf(_u8* buffer, size_t size);
 
 	_u8* getDataBuf() { return data; }
+	const _u8* getDataBuf() const { return data; }
 
 	void fillData(const void* buffer, size_t size);
 	void cleanData();
@@ -109,13 +113,27 @@ public:
 		WORKING_FLAG_ERROR = 0x1L << 31,
 	};
 
+	enum bind_flag_t
+	{
+		// read and decode in the rx thread, no decoder thread is created
+		BIND_FLAG_SINGLE_THREAD = 0x1L << 0,
+	};
+
+	enum {
+		DEFAULT_RX_BUFFER_SIZE = 64 * 1024,
+		// the channel reads into the ring directly when it has at least this much contiguous room
+		RX_BOUNCE_BUFFER_SIZE = 4 * 1024,
+		// receive timestamps of the reads still sitting in the ring
+		RX_TIMESTAMP_MARK_COUNT = 1024,
+	};
+
 
-	AsyncTransceiver(IAsyncProtocolCodec& codec);
+	AsyncTransceiver(IAsyncProtocolCodec& codec, size_t rxBufferSize = DEFAULT_RX_BUFFER_SIZE);
 	~AsyncTransceiver();
 
 
 
-	u_result openChannelAndBind(IChannel* channel);
+	u_result openChannelAndBind(IChannel* channel, _u32 bindFlags = 0);
 	void     unbindAndClose();
 
 	IChannel* getBindedChannel() const {
@@ -124,16 +142,33 @@ public:
 	
 	u_result sendMessage(message_autoptr_t& msg);
 
+	// bytes dropped because the decoder thread could not keep up with the rx thread
+	size_t getRxOverflowCount() const {
+		return _rxRing.getOverflowCount();
+	}
+
+	// receive timestamp reported by the channel for the data currently passed to
+	// IAsyncProtocolCodec::onDecodeData(), 0 if unknown.
+	// only meaningful when called from the decoding callbacks
+	_u64 getDecodingRxTimestamp_uS() const {
+		return _decodingRxTimestamp;
+	}
+
 protected:
 
+	struct RxTimestampMark {
+		size_t endPos;		// ring write position right after the data
+		_u64   timestamp_uS;
+	};
+
 	sl_result _proc_rxThread();
 	sl_result _proc_decoderThread();
+	sl_result _proc_rxDecodeThread();
 
 protected:
 
 
 	rp::hal::Locker _opLocker;
-	rp::hal::Locker _rxLocker;
 	rp::hal::Event  _dataEvt;
 
 	IChannel* _bindedChannel;
@@ -146,21 +181,16 @@ protected:
 	rp::hal::Thread _rxThread;
 	rp::hal::Thread _decoderThread;
 
-	struct Buffer {
-		size_t size;
-		_u8* data;
+	// bytes are passed from the rx thread to the decoder thread through
+	// a preallocated single-producer/single-consumer ring
+	rp::hal::SPSCByteRing _rxRing;
+	// used when the contiguous free span of the ring is smaller than RX_BOUNCE_BUFFER_SIZE
+	std::vector<_u8> _rxBounceBuffer;
+	std::atomic<bool> _decoderWaiting;
 
-
-		Buffer() : size(0), data(NULL){}
-
-		~Buffer() {
-			if (data) {
-				delete[] data;
-				data = NULL;
-			}
-		}
-	};
-	std::list< Buffer * > _rxQueue;
+	// only filled when the channel provides receive timestamps
+	rp::hal::SPSCFixedQueue<RxTimestampMark, RX_TIMESTAMP_MARK_COUNT> _rxTimestampMarks;
+	_u64 _decodingRxTimestamp;
 };
 
 
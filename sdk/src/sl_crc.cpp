@@ -31,10 +31,319 @@
   */
 
 #include "sl_crc.h"  
+#include "sl_crc_internal.h"
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#   define SL_CRC32_HAS_PCLMUL
+#   define SL_CRC32_PCLMUL_TARGET __attribute__((target("sse4.1,pclmul")))
+#   include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#   define SL_CRC32_HAS_PCLMUL
+#   define SL_CRC32_PCLMUL_TARGET
+#   include <intrin.h>
+#   include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) && defined(__aarch64__) && (defined(__linux__) || defined(__ARM_FEATURE_CRC32))
+#   define SL_CRC32_HAS_ARMV8
+#   if defined(__clang__)
+#       define SL_CRC32_ARMV8_TARGET __attribute__((target("crc")))
+#   else
+#       define SL_CRC32_ARMV8_TARGET __attribute__((target("+crc")))
+#   endif
+#   include <arm_acle.h>
+#   if defined(__linux__)
+#       include <sys/auxv.h>
+#       include <asm/hwcap.h>
+#   endif
+#endif
 
 namespace sl {namespace crc32 {
-    
+
+    // the IEEE 802.3 polynomial used by the lidar protocol, the fast paths below are built for it
+    static const sl_u32 DEFAULT_POLY = 0x4C11DB7;
+    static const sl_u32 DEFAULT_POLY_REFLECTED = 0xEDB88320;
+
+    // ------ compile time generated slice-by-8 tables ------
+
+    static constexpr sl_u32 _tableBitStep(sl_u32 c, int bits)
+    {
+        return bits == 0 ? c : _tableBitStep((c & 1) ? (DEFAULT_POLY_REFLECTED ^ (c >> 1)) : (c >> 1), bits - 1);
+    }
+
+    static constexpr sl_u32 _tableEntry(sl_u32 index)
+    {
+        return _tableBitStep(index, 8);
+    }
+
+    // table[n][i] is the crc of byte i followed by n zero bytes
+    static constexpr sl_u32 _sliceEntry(int slice, sl_u32 index)
+    {
+        return slice == 0 ? _tableEntry(index)
+            : ((_sliceEntry(slice - 1, index) >> 8) ^ _tableEntry(_sliceEntry(slice - 1, index) & 0xFF));
+    }
+
+    template <unsigned... Is> struct _index_list {};
+    template <unsigned N, unsigned... Is> struct _make_index_list : _make_index_list<N - 1, N - 1, Is...> {};
+    template <unsigned... Is> struct _make_index_list<0, Is...> { typedef _index_list<Is...> type; };
+
+    struct SliceTables {
+        sl_u32 t[8][256];
+    };
+
+    template <unsigned... Is>
+    static constexpr SliceTables _makeSliceTables(_index_list<Is...>)
+    {
+        return SliceTables{ {
+            { _sliceEntry(0, Is)... }, { _sliceEntry(1, Is)... },
+            { _sliceEntry(2, Is)... }, { _sliceEntry(3, Is)... },
+            { _sliceEntry(4, Is)... }, { _sliceEntry(5, Is)... },
+            { _sliceEntry(6, Is)... }, { _sliceEntry(7, Is)... },
+        } };
+    }
+
+    static constexpr SliceTables slice_tables = _makeSliceTables(_make_index_list<256>::type());
+
+    // table for a custom polynomial set via init()
     static sl_u32 table[256];//crc32_table
+    static bool   use_custom_table = false;
+
+    using internal::crc_update_proc_t;
+
+    static inline sl_u32 _updateBytes(sl_u32 crc, const sl_u8* data, size_t len)
+    {
+        while (len--) {
+            crc = (crc >> 8) ^ slice_tables.t[0][(crc ^ *data++) & 0xFF];
+        }
+        return crc;
+    }
+
+    static sl_u32 _updateSlice8(sl_u32 crc, const sl_u8* data, size_t len)
+    {
+#ifndef _CPU_ENDIAN_BIG
+        while (len >= 8) {
+            sl_u32 one, two;
+            memcpy(&one, data, 4);
+            memcpy(&two, data + 4, 4);
+            one ^= crc;
+
+            crc = slice_tables.t[7][one & 0xFF] ^ slice_tables.t[6][(one >> 8) & 0xFF]
+                ^ slice_tables.t[5][(one >> 16) & 0xFF] ^ slice_tables.t[4][one >> 24]
+                ^ slice_tables.t[3][two & 0xFF] ^ slice_tables.t[2][(two >> 8) & 0xFF]
+                ^ slice_tables.t[1][(two >> 16) & 0xFF] ^ slice_tables.t[0][two >> 24];
+
+            data += 8;
+            len -= 8;
+        }
+#endif
+        return _updateBytes(crc, data, len);
+    }
+
+#ifdef SL_CRC32_HAS_PCLMUL
+    // carry-less multiplication folding, see Intel's paper
+    // "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction"
+    // requires len >= 64 and len to be a multiple of 16
+    SL_CRC32_PCLMUL_TARGET
+    static sl_u32 _updatePclmulBlocks(sl_u32 crc, const sl_u8* buf, size_t len)
+    {
+        // bit-reflected constants k1..k5 and the Barrett reduction polynomials
+        static const sl_u64 k1k2[] = { 0x0154442bd4ULL, 0x01c6e41596ULL };
+        static const sl_u64 k3k4[] = { 0x01751997d0ULL, 0x00ccaa009eULL };
+        static const sl_u64 k5k0[] = { 0x0163cd6124ULL, 0x0000000000ULL };
+        static const sl_u64 poly[] = { 0x01db710641ULL, 0x01f7011641ULL };
+
+        __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+        x1 = _mm_loadu_si128((const __m128i*)(buf + 0x00));
+        x2 = _mm_loadu_si128((const __m128i*)(buf + 0x10));
+        x3 = _mm_loadu_si128((const __m128i*)(buf + 0x20));
+        x4 = _mm_loadu_si128((const __m128i*)(buf + 0x30));
+
+        x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)crc));
+        x0 = _mm_loadu_si128((const __m128i*)k1k2);
+
+        buf += 64;
+        len -= 64;
+
+        // fold 4 x 128bit in parallel
+        while (len >= 64) {
+            x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+            x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+            x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+            x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+            x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+            x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+            x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+            x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+            y5 = _mm_loadu_si128((const __m128i*)(buf + 0x00));
+            y6 = _mm_loadu_si128((const __m128i*)(buf + 0x10));
+            y7 = _mm_loadu_si128((const __m128i*)(buf + 0x20));
+            y8 = _mm_loadu_si128((const __m128i*)(buf + 0x30));
+
+            x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+            x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+            x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+            x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+
+            buf += 64;
+            len -= 64;
+        }
+
+        // fold into 128bit
+        x0 = _mm_loadu_si128((const __m128i*)k3k4);
+
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+        // fold the remaining 128bit blocks
+        while (len >= 16) {
+            x2 = _mm_loadu_si128((const __m128i*)buf);
+
+            x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+            x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+            x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+            buf += 16;
+            len -= 16;
+        }
+
+        // fold 128bit to 64bit
+        x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+        x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+        x1 = _mm_srli_si128(x1, 8);
+        x1 = _mm_xor_si128(x1, x2);
+
+        x0 = _mm_loadl_epi64((const __m128i*)k5k0);
+
+        x2 = _mm_srli_si128(x1, 4);
+        x1 = _mm_and_si128(x1, x3);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_xor_si128(x1, x2);
+
+        // Barrett reduction to 32bit
+        x0 = _mm_loadu_si128((const __m128i*)poly);
+
+        x2 = _mm_and_si128(x1, x3);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+        x2 = _mm_and_si128(x2, x3);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x1 = _mm_xor_si128(x1, x2);
+
+        return (sl_u32)_mm_extract_epi32(x1, 1);
+    }
+
+    static sl_u32 _updatePclmul(sl_u32 crc, const sl_u8* data, size_t len)
+    {
+        if (len >= 64) {
+            size_t blockLen = len & ~(size_t)15;
+            crc = _updatePclmulBlocks(crc, data, blockLen);
+            data += blockLen;
+            len -= blockLen;
+        }
+        return _updateSlice8(crc, data, len);
+    }
+
+    static bool _cpuSupportsPclmul()
+    {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        // ecx bit 1: PCLMULQDQ, bit 19: SSE4.1
+        return (info[2] & (1 << 1)) && (info[2] & (1 << 19));
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+#endif
+    }
+#endif
+
+#ifdef SL_CRC32_HAS_ARMV8
+    SL_CRC32_ARMV8_TARGET
+    static sl_u32 _updateArmv8(sl_u32 crc, const sl_u8* data, size_t len)
+    {
+        while (len >= 8) {
+            sl_u64 value;
+            memcpy(&value, data, 8);
+            crc = __crc32d(crc, value);
+            data += 8;
+            len -= 8;
+        }
+        while (len--) {
+            crc = __crc32b(crc, *data++);
+        }
+        return crc;
+    }
+
+    static bool _cpuSupportsArmv8Crc()
+    {
+#if defined(__ARM_FEATURE_CRC32)
+        return true;
+#else
+        return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+#endif
+    }
+#endif
+
+    static crc_update_proc_t _selectUpdateProc()
+    {
+#ifdef SL_CRC32_HAS_ARMV8
+        if (_cpuSupportsArmv8Crc()) return &_updateArmv8;
+#endif
+#ifdef SL_CRC32_HAS_PCLMUL
+        if (_cpuSupportsPclmul()) return &_updatePclmul;
+#endif
+        return &_updateSlice8;
+    }
+
+    namespace internal {
+        size_t getUpdateVariants(CrcUpdateVariant* variants, size_t maxCount)
+        {
+            size_t count = 0;
+            CrcUpdateVariant candidates[4];
+
+            candidates[count].name = "byte-wise";
+            candidates[count++].update = &_updateBytes;
+            candidates[count].name = "slice-by-8";
+            candidates[count++].update = &_updateSlice8;
+#ifdef SL_CRC32_HAS_PCLMUL
+            if (_cpuSupportsPclmul()) {
+                candidates[count].name = "PCLMULQDQ";
+                candidates[count++].update = &_updatePclmul;
+            }
+#endif
+#ifdef SL_CRC32_HAS_ARMV8
+            if (_cpuSupportsArmv8Crc()) {
+                candidates[count].name = "ARMv8 CRC32";
+                candidates[count++].update = &_updateArmv8;
+            }
+#endif
+            if (count > maxCount) count = maxCount;
+            for (size_t pos = 0; pos < count; ++pos) {
+                variants[pos] = candidates[pos];
+            }
+            return count;
+        }
+    }
+
+    static sl_u32 _update(sl_u32 crc, const sl_u8* data, size_t len)
+    {
+        // thread-safe one time selection
+        static const crc_update_proc_t updateProc = _selectUpdateProc();
+        return updateProc(crc, data, len);
+    }
+
     sl_u32 bitrev(sl_u32 input, sl_u16 bw)
     {
         sl_u16 i;
@@ -55,6 +364,12 @@ namespace sl {namespace crc32 {
         sl_u16 j;
         sl_u32 c;
 
+        // the tables of the default polynomial are generated at compile time
+        if (poly == DEFAULT_POLY) {
+            use_custom_table = false;
+            return;
+        }
+
         poly = bitrev(poly, 32);
         for (i = 0; i < 256; i++) {
             c = i;
@@ -66,6 +381,7 @@ namespace sl {namespace crc32 {
             }
             table[i] = c;
         }
+        use_custom_table = true;
     }
 
     sl_u32 cal(sl_u32 crc, void* input, sl_u16 len)
@@ -76,6 +392,13 @@ namespace sl {namespace crc32 {
         pch = (unsigned char*)input;
         sl_u8 leftBytes = 4 - (len & 0x3);
 
+        if (!use_custom_table) {
+            static const sl_u8 zeros[4] = { 0, 0, 0, 0 };
+            crc = _update(crc, pch, len);
+            crc = _updateBytes(crc, zeros, leftBytes); //zero padding
+            return crc ^ 0xffffffff;
+        }
+
         for (i = 0; i < len; i++) {
             index = (unsigned char)(crc^*pch);
             crc = (crc >> 8) ^ table[index];
@@ -91,12 +414,11 @@ namespace sl {namespace crc32 {
 
     sl_result getResult(sl_u8 *ptr, sl_u32 len) 
     {
-        static sl_u8 tmp;
-        if (tmp != 1) {
-            init(0x4C11DB7);
-            tmp = 1;
-        }
+        static const sl_u8 zeros[4] = { 0, 0, 0, 0 };
+        sl_u8 leftBytes = 4 - (len & 0x3);
 
-        return cal(0xFFFFFFFF, ptr, len);
+        sl_u32 crc = _update(0xFFFFFFFF, ptr, len);
+        crc = _updateBytes(crc, zeros, leftBytes); //zero padding
+        return crc ^ 0xffffffff;
     }
-}}
\ No newline at end of file
+}}
@@ -45,7 +45,7 @@
 #include <algorithm>
 #include <memory>
 #include <atomic>
-#include <deque>
+#include <math.h>
 
 #include "dataunpacker/dataunpacker.h"
 #include "sl_async_transceiver.h"
@@ -88,25 +88,36 @@ namespace sl {
     }
 
 
-    static inline float getAngle(const sl_lidar_response_measurement_node_t& node)
+    // the angle in the node's native fixed point format
+    static inline sl_u32 getAngleRaw(const sl_lidar_response_measurement_node_t& node)
     {
-        return (node.angle_q6_checkbit >> SL_LIDAR_RESP_MEASUREMENT_ANGLE_SHIFT) / 64.f;
+        return node.angle_q6_checkbit >> SL_LIDAR_RESP_MEASUREMENT_ANGLE_SHIFT;
     }
 
-    static inline void setAngle(sl_lidar_response_measurement_node_t& node, float v)
+    static inline void setAngleRaw(sl_lidar_response_measurement_node_t& node, sl_u32 v)
     {
         sl_u16 checkbit = node.angle_q6_checkbit & SL_LIDAR_RESP_MEASUREMENT_CHECKBIT;
-        node.angle_q6_checkbit = (((sl_u16)(v * 64.0f)) << SL_LIDAR_RESP_MEASUREMENT_ANGLE_SHIFT) | checkbit;
+        node.angle_q6_checkbit = (((sl_u16)v) << SL_LIDAR_RESP_MEASUREMENT_ANGLE_SHIFT) | checkbit;
     }
 
-    static inline float getAngle(const sl_lidar_response_measurement_node_hq_t& node)
+    static inline sl_u32 getAngleRawFullCircle(const sl_lidar_response_measurement_node_t&)
     {
-        return node.angle_z_q14 * 90.f / 16384.f;
+        return 360 << 6;
     }
 
-    static inline void setAngle(sl_lidar_response_measurement_node_hq_t& node, float v)
+    static inline sl_u32 getAngleRaw(const sl_lidar_response_measurement_node_hq_t& node)
     {
-        node.angle_z_q14 = sl_u32(v * 16384.f / 90.f);
+        return node.angle_z_q14;
+    }
+
+    static inline void setAngleRaw(sl_lidar_response_measurement_node_hq_t& node, sl_u32 v)
+    {
+        node.angle_z_q14 = (sl_u16)v; // 360 degree wraps to 0
+    }
+
+    static inline sl_u32 getAngleRawFullCircle(const sl_lidar_response_measurement_node_hq_t&)
+    {
+        return 4 << 14; // 90 degree is 1<<14
     }
 
     static inline sl_u16 getDistanceQ2(const sl_lidar_response_measurement_node_t& node)
@@ -122,13 +133,61 @@ namespace sl {
     template <class TNode>
     static bool angleLessThan(const TNode& a, const TNode& b)
     {
-        return getAngle(a) < getAngle(b);
+        return getAngleRaw(a) < getAngleRaw(b);
+    }
+
+    // The samples of a scan are already in ascending order except for a single wrap point (360 -> 0)
+    // and some local disorder, so rotating at the wrap point followed by an insertion sort is linear
+    // in practice. Falls back to std::sort if the data turns out to be far from ordered.
+    template < class TNode >
+    static void sortScanByAngle_(TNode * nodebuffer, size_t count)
+    {
+        size_t i;
+        size_t wrapPos = 0;
+        sl_u32 maxDrop = 0;
+
+        for (i = 1; i < count; i++) {
+            sl_u32 prevAngle = getAngleRaw(nodebuffer[i - 1]);
+            sl_u32 currentAngle = getAngleRaw(nodebuffer[i]);
+            if (currentAngle < prevAngle && (prevAngle - currentAngle) > maxDrop) {
+                maxDrop = prevAngle - currentAngle;
+                wrapPos = i;
+            }
+        }
+
+        if (maxDrop > (getAngleRawFullCircle(nodebuffer[0]) >> 1)) {
+            std::rotate(nodebuffer, nodebuffer + wrapPos, nodebuffer + count);
+        }
+
+        size_t moveBudget = count * 8;
+        for (i = 1; i < count; i++) {
+            TNode key = nodebuffer[i];
+            sl_u32 keyAngle = getAngleRaw(key);
+            size_t pos = i;
+
+            while (pos > 0 && getAngleRaw(nodebuffer[pos - 1]) > keyAngle && moveBudget) {
+                nodebuffer[pos] = nodebuffer[pos - 1];
+                --pos;
+                --moveBudget;
+            }
+            nodebuffer[pos] = key;
+
+            if (!moveBudget) {
+                std::sort(nodebuffer, nodebuffer + count, &angleLessThan<TNode>);
+                return;
+            }
+        }
     }
 
     template < class TNode >
     static sl_result ascendScanData_(TNode * nodebuffer, size_t count)
     {
-        float inc_origin_angle = 360.f / count;
+        if (!count) return SL_RESULT_OPERATION_FAIL;
+
+        // all the angle calculation is done in the node's fixed point format, 
+        // the increment carries extra 16 fraction bits
+        const sl_s64 fullCircle = getAngleRawFullCircle(nodebuffer[0]);
+        const sl_s64 inc_origin_angle_q16 = (fullCircle << 16) / (sl_s64)count;
         size_t i = 0;
 
         //Tune head
@@ -139,9 +198,9 @@ namespace sl {
             else {
                 while (i != 0) {
                     i--;
-                    float expect_angle = getAngle(nodebuffer[i + 1]) - inc_origin_angle;
-                    if (expect_angle < 0.0f) expect_angle = 0.0f;
-                    setAngle(nodebuffer[i], expect_angle);
+                    sl_s64 expect_angle_q16 = ((sl_s64)getAngleRaw(nodebuffer[i + 1]) << 16) - inc_origin_angle_q16;
+                    if (expect_angle_q16 < 0) expect_angle_q16 = 0;
+                    setAngleRaw(nodebuffer[i], (sl_u32)(expect_angle_q16 >> 16));
                 }
                 break;
             }
@@ -159,94 +218,444 @@ namespace sl {
             else {
                 while (i != (count - 1)) {
                     i++;
-                    float expect_angle = getAngle(nodebuffer[i - 1]) + inc_origin_angle;
-                    if (expect_angle > 360.0f) expect_angle -= 360.0f;
-                    setAngle(nodebuffer[i], expect_angle);
+                    sl_s64 expect_angle_q16 = ((sl_s64)getAngleRaw(nodebuffer[i - 1]) << 16) + inc_origin_angle_q16;
+                    if (expect_angle_q16 > (fullCircle << 16)) expect_angle_q16 -= (fullCircle << 16);
+                    setAngleRaw(nodebuffer[i], (sl_u32)(expect_angle_q16 >> 16));
                 }
                 break;
             }
         }
 
         //Fill invalid angle in the scan
-        float frontAngle = getAngle(nodebuffer[0]);
+        sl_s64 frontAngle_q16 = (sl_s64)getAngleRaw(nodebuffer[0]) << 16;
         for (i = 1; i < count; i++) {
             if (getDistanceQ2(nodebuffer[i]) == 0) {
-                float expect_angle = frontAngle + i * inc_origin_angle;
-                if (expect_angle > 360.0f) expect_angle -= 360.0f;
-                setAngle(nodebuffer[i], expect_angle);
+                sl_s64 expect_angle_q16 = frontAngle_q16 + (sl_s64)i * inc_origin_angle_q16;
+                if (expect_angle_q16 > (fullCircle << 16)) expect_angle_q16 -= (fullCircle << 16);
+                setAngleRaw(nodebuffer[i], (sl_u32)(expect_angle_q16 >> 16));
             }
         }
 
         // Reorder the scan according to the angle value
-        std::sort(nodebuffer, nodebuffer + count, &angleLessThan<TNode>);
+        sortScanByAngle_(nodebuffer, count);
 
         return SL_RESULT_OK;
     }
 
+    LidarScanFrame::LidarScanFrame()
+        : count(0)
+        , begin_timestamp_uS(0)
+        , end_timestamp_uS(0)
+        , scan_sequence(0)
+        , motion_compensated(false)
+        , _storage(nullptr)
+        , _capacity(0)
+        , _angle_z_q14(nullptr)
+        , _dist_mm_q2(nullptr)
+        , _timestamp_offset_uS(nullptr)
+        , _quality(nullptr)
+        , _flag(nullptr)
+    {
+    }
+
+    LidarScanFrame::~LidarScanFrame()
+    {
+        free(_storage);
+    }
+
+    bool LidarScanFrame::reserve(size_t capacity)
+    {
+        if (capacity <= _capacity) return true;
+
+        // round up so that every array ends on an aligned boundary as well
+        capacity = (capacity + DATA_ALIGNMENT - 1) & ~(size_t)(DATA_ALIGNMENT - 1);
+        size_t bytesPerSample = sizeof(sl_u32) + sizeof(sl_s32) + sizeof(sl_u16) + sizeof(sl_u8) + sizeof(sl_u8);
+
+        void* storage = malloc(capacity * bytesPerSample + DATA_ALIGNMENT);
+        if (!storage) return false;
+
+        free(_storage);
+        _storage = storage;
+        _capacity = capacity;
+        count = 0;
+
+        _u8* base = (_u8*)(((size_t)storage + DATA_ALIGNMENT - 1) & ~(size_t)(DATA_ALIGNMENT - 1));
+        _dist_mm_q2 = (sl_u32*)base;
+        _timestamp_offset_uS = (sl_s32*)(_dist_mm_q2 + capacity);
+        _angle_z_q14 = (sl_u16*)(_timestamp_offset_uS + capacity);
+        _quality = (sl_u8*)(_angle_z_q14 + capacity);
+        _flag = _quality + capacity;
+        return true;
+    }
+
+    bool LidarScanFrame::copyFrom(const LidarScanFrame& src)
+    {
+        if (this == &src) return true;
+        if (!reserve(src.count)) return false;
+
+        if (src.count) {
+            memcpy(_angle_z_q14, src._angle_z_q14, src.count * sizeof(sl_u16));
+            memcpy(_dist_mm_q2, src._dist_mm_q2, src.count * sizeof(sl_u32));
+            memcpy(_timestamp_offset_uS, src._timestamp_offset_uS, src.count * sizeof(sl_s32));
+            memcpy(_quality, src._quality, src.count);
+            memcpy(_flag, src._flag, src.count);
+        }
+        count = src.count;
+        begin_timestamp_uS = src.begin_timestamp_uS;
+        end_timestamp_uS = src.end_timestamp_uS;
+        scan_sequence = src.scan_sequence;
+        motion_compensated = src.motion_compensated;
+        return true;
+    }
+
     template<typename T>
     class RawSampleNodeHolder
     {
     public:
         RawSampleNodeHolder(size_t maxcount = 8192)
-            : _max_count(maxcount)
+            : _head(0)
+            , _tail(0)
+            , _dropped_count(0)
         {
-           
+            // the capacity is rounded up to the power of 2
+            size_t capacity = 1;
+            while (capacity < maxcount) capacity <<= 1;
+            _ring.resize(capacity);
+            _mask = capacity - 1;
         }
+
         void clear()
         {
             rp::hal::AutoLocker l(_locker);
             _data_waiter.set(false);
-            _data_queue.clear();
+            _head = _tail = 0;
         }
 
         void pushNode(_u64 timestamp_uS, const T* node)
+        {
+            pushNodes(&timestamp_uS, node, 1);
+        }
+
+        void pushNodes(const _u64* timestamp_uS, const T* nodes, size_t count)
         {
             rp::hal::AutoLocker l(_locker);
-            _data_queue.push_back(*node);
-            if (_data_queue.size() > _max_count) {
-                _data_queue.pop_front();
+            size_t capacity = _ring.size();
+
+            if (count > capacity) {
+                // only the latest ones can be kept
+                _dropped_count += count - capacity;
+                nodes += count - capacity;
+                count = capacity;
+            }
+
+            size_t freeSize = capacity - (_head - _tail);
+            if (count > freeSize) {
+                // discard the oldest nodes
+                _dropped_count += count - freeSize;
+                _tail += count - freeSize;
             }
+
+            size_t offset = _head & _mask;
+            size_t firstPart = std::min<size_t>(count, capacity - offset);
+            memcpy(&_ring[offset], nodes, firstPart * sizeof(T));
+            memcpy(&_ring[0], nodes + firstPart, (count - firstPart) * sizeof(T));
+            _head += count;
+
             _data_waiter.set();
         }
 
         size_t waitAndFetch(T* node, size_t maxcount, _u32 timeout)
         {
+            if (!maxcount) return 0;
+
+            {
+                rp::hal::AutoLocker l(_locker);
+                if (_head != _tail) return _fetch_locked(node, maxcount);
+            }
+
             if (_data_waiter.wait(timeout) == rp::hal::Event::EVENT_OK)
             {
                 rp::hal::AutoLocker l(_locker);
+                return _fetch_locked(node, maxcount);
+            }
+            return 0;
+        }
+
+        // count of the nodes discarded before they could be fetched
+        _u64 getDroppedCount()
+        {
+            rp::hal::AutoLocker l(_locker);
+            return _dropped_count;
+        }
+
+    protected:
+        size_t _fetch_locked(T* node, size_t maxcount)
+        {
+            size_t copiedCount = std::min<size_t>(maxcount, _head - _tail);
+            size_t offset = _tail & _mask;
+            size_t firstPart = std::min<size_t>(copiedCount, _ring.size() - offset);
+
+            memcpy(node, &_ring[offset], firstPart * sizeof(T));
+            memcpy(node + firstPart, &_ring[0], (copiedCount - firstPart) * sizeof(T));
+            _tail += copiedCount;
+            return copiedCount;
+        }
+
+        rp::hal::Locker _locker;
+        rp::hal::Event  _data_waiter;
+        std::vector<T>  _ring;
+        size_t          _mask;
+        size_t          _head;
+        size_t          _tail;
+        _u64            _dropped_count;
+        
+    };
+
+    // FIFO of the latest completed scans, the consumer fetches them one by one without missing any
+    // as long as it keeps up on average. All the storage is allocated by setDepth().
+    // The consumer claims a slot under the lock and copies it outside, so the decoder thread never
+    // waits for a copy. A scan completed while its slot is still being read is dropped instead.
+    class ScanHistoryRing
+    {
+    public:
+        ScanHistoryRing()
+            : _enabled(false)
+            , _head(0)
+            , _tail(0)
+            , _dropped_count(0)
+        {
+        }
+
+        sl_result setDepth(size_t depth, size_t maxcount)
+        {
+            rp::hal::AutoLocker l(_locker);
+            _enabled = false;
+            _storage.reset();
+            _head = _tail = 0;
+            _data_waiter.set(false);
+
+            if (!depth) return SL_RESULT_OK;
 
-                size_t copiedCount = 0;
+            // a fetch in progress keeps the previous storage alive until it is done
+            std::shared_ptr<HistoryStorage> storage(new (std::nothrow) HistoryStorage());
+            if (!storage) return SL_RESULT_INSUFFICIENT_MEMORY;
+            storage->slots.reset(new (std::nothrow) HistorySlot[depth]);
+            if (!storage->slots) return SL_RESULT_INSUFFICIENT_MEMORY;
+            for (size_t pos = 0; pos < depth; ++pos) {
+                if (!storage->slots[pos].frame.reserve(maxcount)) return SL_RESULT_INSUFFICIENT_MEMORY;
+            }
+            storage->depth = depth;
+
+            _storage = std::move(storage);
+            _enabled = true;
+            return SL_RESULT_OK;
+        }
+
+        void clear()
+        {
+            rp::hal::AutoLocker l(_locker);
+            _head = _tail = 0;
+            _data_waiter.set(false);
+        }
+
+        void push(const LidarScanFrame& frame)
+        {
+            if (!_enabled) return;
+
+            rp::hal::AutoLocker l(_locker);
+            if (!_storage) return;
 
-                while (maxcount--) {
-                    node[copiedCount++] = _data_queue.front();
-                    _data_queue.pop_front();
+            HistorySlot& slot = _storage->slots[_head % _storage->depth];
+            if (slot.reading) {
+                // the consumer is still copying the scan previously stored in this slot
+                ++_dropped_count;
+                return;
+            }
+
+            if (_head - _tail >= _storage->depth) {
+                // overwrite the oldest scan
+                ++_tail;
+                ++_dropped_count;
+            }
+            slot.frame.copyFrom(frame);
+            ++_head;
+            _data_waiter.set();
+        }
+
+        sl_result waitAndFetch(LidarScanFrame& frame, _u32 timeout)
+        {
+            std::shared_ptr<HistoryStorage> storage;
+            HistorySlot* slot = nullptr;
+
+            _u64 deadline = getms() + timeout;
+            while (true) {
+                {
+                    rp::hal::AutoLocker l(_locker);
+                    if (!_storage) return SL_RESULT_OPERATION_NOT_SUPPORT;
+                    if (_head != _tail) {
+                        storage = _storage;
+                        slot = &storage->slots[_tail % storage->depth];
+                        slot->reading = true;
+                        ++_tail;
+                        break;
+                    }
                 }
 
-                return copiedCount;
+                _u64 currentTs = getms();
+                if (currentTs >= deadline) return SL_RESULT_OPERATION_TIMEOUT;
+                if (_data_waiter.wait((_u32)(deadline - currentTs)) == rp::hal::Event::EVENT_FAILED) return SL_RESULT_OPERATION_FAIL;
             }
-            return 0;
+
+            bool copied = frame.copyFrom(slot->frame);
+
+            rp::hal::AutoLocker l(_locker);
+            slot->reading = false;
+            return copied ? SL_RESULT_OK : SL_RESULT_INSUFFICIENT_MEMORY;
         }
+
+        // count of the scans overwritten or dropped before they could be fetched
+        _u64 getDroppedCount()
+        {
+            rp::hal::AutoLocker l(_locker);
+            return _dropped_count;
+        }
+
     protected:
-        size_t          _max_count;
+        struct HistorySlot {
+            LidarScanFrame frame;
+            bool           reading; // claimed by waitAndFetch(), the decoder must not overwrite it
+
+            HistorySlot() : reading(false) {}
+        };
+
+        struct HistoryStorage {
+            std::unique_ptr<HistorySlot[]> slots;
+            size_t depth;
+
+            HistoryStorage() : depth(0) {}
+        };
+
         rp::hal::Locker _locker;
         rp::hal::Event  _data_waiter;
-        std::deque<T>   _data_queue;
-        
+
+        std::atomic<bool> _enabled;
+        std::shared_ptr<HistoryStorage> _storage;
+        _u64   _head;
+        _u64   _tail;
+        _u64   _dropped_count;
     };
 
+    static const double PI = 3.14159265358979323846;
+    static const double ANGLE_Q14_TO_RAD = 2 * PI / 65536;
+
     template<typename T>
     class ScanDataHolder
     {
     public:
+        enum {
+            MAX_SCAN_LEASE_COUNT = 4,
+            SCAN_BUFFER_COUNT = 3 + MAX_SCAN_LEASE_COUNT,
+        };
+
+        // Triple buffering: the decoder thread fills the write buffer, the completed
+        // scan is swapped into the middle slot and the consumer swaps the middle slot
+        // with its read buffer. Neither side ever waits for the other one.
+        // A leased read buffer leaves the rotation and is replaced by a spare one.
+        enum {
+            BUFFER_INDEX_MASK = 0x7,
+            BUFFER_DIRTY_FLAG = 0x8, // set if the middle slot holds a scan not fetched yet
+        };
+
+        // motion compensation state of the scan being received
+        struct DeskewState {
+            ILidarPoseProvider* provider; // NULL if the scan is not compensated
+            LidarPose2D         begin_pose;
+            double              begin_cos_yaw;
+            double              begin_sin_yaw;
+            // the samples in the LIDAR frame at the beginning of the scan (in millimeters)
+            std::vector<float>  x;
+            std::vector<float>  y;
+        };
+
+        // the frame mirrors the nodes in SoA layout and carries the scan info
+        struct ScanBuffer {
+            std::vector<T> nodes;
+            LidarScanFrame frame;
+            DeskewState    deskew;
+
+            void clear() {
+                nodes.clear();
+                frame.count = 0;
+                frame.motion_compensated = false;
+                deskew.provider = nullptr;
+            }
+        };
+
+        // shared with the outstanding leases, so they may outlive the holder
+        struct ScanBufferPool {
+            ScanBuffer       buffers[SCAN_BUFFER_COUNT];
+            rp::hal::Locker  locker;
+            std::vector<int> free_ids;
+
+            void release(int id) {
+                rp::hal::AutoLocker l(locker);
+                free_ids.push_back(id);
+            }
+        };
+
+        class ScanLease : public ILidarScanLease
+        {
+        public:
+            ScanLease(const std::shared_ptr<ScanBufferPool>& pool, int id)
+                : _pool(pool), _id(id)
+            {}
+
+            virtual ~ScanLease() {
+                _pool->release(_id);
+            }
+
+            virtual const T* getNodes() const {
+                return _pool->buffers[_id].nodes.empty() ? nullptr : &_pool->buffers[_id].nodes[0];
+            }
+
+            virtual size_t getNodeCount() const {
+                return _pool->buffers[_id].nodes.size();
+            }
+
+            virtual sl_u64 getBeginTimestamp_uS() const {
+                return _pool->buffers[_id].frame.begin_timestamp_uS;
+            }
+
+            virtual sl_u64 getScanSequence() const {
+                return _pool->buffers[_id].frame.scan_sequence;
+            }
+
+            virtual const LidarScanFrame& getFrame() const {
+                return _pool->buffers[_id].frame;
+            }
+
+        protected:
+            std::shared_ptr<ScanBufferPool> _pool;
+            int _id;
+        };
+
         ScanDataHolder(size_t maxcount = 8192) 
             : _scan_node_buffer_size(maxcount)
-            , _scan_node_available_id(-1)
+            , _pool(std::make_shared<ScanBufferPool>())
+            , _write_id(0)
+            , _read_id(2)
+            , _middle_id(1)
+            , _scan_sequence(0)
             , _new_scan_ready(false)
+            , _sample_sink(nullptr)
+            , _pose_provider(nullptr)
         {
-            _scanbuffer[0].reserve(_scan_node_buffer_size);
-            _scanbuffer[1].reserve(_scan_node_buffer_size);
-
-            memset(_scan_begin_timestamp_uS, 0, sizeof(_scan_begin_timestamp_uS));
+            for (int pos = 0; pos < SCAN_BUFFER_COUNT; ++pos) {
+                _pool->buffers[pos].nodes.reserve(_scan_node_buffer_size);
+                _pool->buffers[pos].frame.reserve(_scan_node_buffer_size);
+                _pool->buffers[pos].clear();
+                if (pos >= 3) _pool->free_ids.push_back(pos);
+            }
         }
 
         size_t getMaxCacheCount() const {
@@ -256,12 +665,14 @@ namespace sl {
 
         void reset() {
             rp::hal::AutoLocker l(_locker);
-            _scan_node_available_id = -1;
+            // the leased buffers are left untouched, only the ones in rotation are cleared
+            _middle_id = _middle_id & BUFFER_INDEX_MASK;
             _new_scan_ready = false;
-            _scanbuffer[0].clear();
-            _scanbuffer[1].clear();
+            _getBuffer(_write_id).clear();
+            _getBuffer(_middle_id).clear();
+            _getBuffer(_read_id).clear();
             _data_waiter.set(false);
-            memset(_scan_begin_timestamp_uS, 0, sizeof(_scan_begin_timestamp_uS));
+            _history.clear();
         }
 
         bool checkNewScanSignalAndReset()
@@ -269,17 +680,100 @@ namespace sl {
             return _new_scan_ready.exchange(false);
         }
 
+        // the sink is notified of every completed scan from the producer thread
+        void setSampleSink(ILidarSampleSink* sink)
+        {
+            _sample_sink = sink;
+        }
+
+        sl_result setHistoryDepth(size_t depth)
+        {
+            return _history.setDepth(depth, _scan_node_buffer_size);
+        }
+
+        ScanHistoryRing& getHistory()
+        {
+            return _history;
+        }
+
+        // the provider is picked up at the beginning of every scan
+        void setPoseProvider(ILidarPoseProvider* provider)
+        {
+            _pose_provider = provider;
+        }
+
         void pushScanNodeData(_u64 currentSampleTsUs, const T* hqNode)
         {
             rp::hal::AutoLocker l(_locker);
+            _pushScanNodeData_locked(currentSampleTsUs, hqNode);
+        }
+
+        void pushScanNodesData(const _u64* sampleTsUs, const T* hqNodes, size_t count)
+        {
+            rp::hal::AutoLocker l(_locker);
+            for (size_t pos = 0; pos < count; ++pos) {
+                _pushScanNodeData_locked(sampleTsUs[pos], hqNodes + pos);
+            }
+        }
 
-            int  operationBufID = _getOperationBufferID_locked();
-            auto operationalBuf = &_scanbuffer[operationBufID];
+        void rewindCurrentScanData() {
+            rp::hal::AutoLocker l(_locker);
+            _getBuffer(_write_id).clear();
+        }
+
+        // Wait for the latest completed scan. The returned buffer is owned by the
+        // calling thread until its next call to this function (single consumer).
+        const ScanBuffer* waitForLatestScan(_u32 timeout)
+        {
+            _u64 deadline = getms() + timeout;
+            while (!(_middle_id.load() & BUFFER_DIRTY_FLAG)) {
+                _u64 currentTs = getms();
+                if (currentTs >= deadline) return nullptr;
+                if (_data_waiter.wait((_u32)(deadline - currentTs)) == rp::hal::Event::EVENT_FAILED) return nullptr;
+            }
+
+            _read_id = _middle_id.exchange(_read_id) & BUFFER_INDEX_MASK;
+            _new_scan_ready = false;
+            return &_getBuffer(_read_id);
+        }
+
+        // Same as waitForLatestScan but hands the buffer over to a lease
+        sl_result waitAndLeaseLatestScan(std::shared_ptr<const ILidarScanLease>& outLease, _u32 timeout)
+        {
+            {
+                rp::hal::AutoLocker l(_pool->locker);
+                if (_pool->free_ids.empty()) {
+                    // too many outstanding leases
+                    return SL_RESULT_INSUFFICIENT_MEMORY;
+                }
+            }
+
+            if (!waitForLatestScan(timeout)) return SL_RESULT_OPERATION_TIMEOUT;
+
+            int leasedId = _read_id;
+            {
+                // only the releases may happen concurrently, a spare one is still there
+                rp::hal::AutoLocker l(_pool->locker);
+                _read_id = _pool->free_ids.back();
+                _pool->free_ids.pop_back();
+            }
+
+            outLease = std::make_shared<ScanLease>(_pool, leasedId);
+            return SL_RESULT_OK;
+        }
+
+    protected:
+        ScanBuffer& _getBuffer(int id) {
+            return _pool->buffers[id & BUFFER_INDEX_MASK];
+        }
+
+        void _pushScanNodeData_locked(_u64 currentSampleTsUs, const T* hqNode)
+        {
+            ScanBuffer* operationalBuf = &_getBuffer(_write_id);
             
             if (hqNode->flag & RPLIDAR_RESP_HQ_FLAG_SYNCBIT) {
-                if (operationalBuf->size()) {
-                    operationBufID = _finishCurrentScanAndSwap_locked();
-                    operationalBuf = &_scanbuffer[operationBufID];
+                if (operationalBuf->nodes.size()) {
+                    operationalBuf = _finishCurrentScanAndSwap_locked();
 
                     // publish the available scan
                     _new_scan_ready = true;
@@ -287,87 +781,332 @@ namespace sl {
 
                 }
                 
-                assert(operationalBuf->size() == 0);
+                assert(operationalBuf->nodes.size() == 0);
 
                 //store the timestamp info
-                _scan_begin_timestamp_uS[operationBufID] = currentSampleTsUs;
+                operationalBuf->frame.begin_timestamp_uS = currentSampleTsUs;
+                _beginDeskew(*operationalBuf, currentSampleTsUs);
             }
             else {
-                if (operationalBuf->size() == 0) {
+                if (operationalBuf->nodes.size() == 0) {
                     //discard the data, do not form partial scan
                     return;
                 }
             }
 
-            if (operationalBuf->size() >= _scan_node_buffer_size) {
+            size_t pos = operationalBuf->nodes.size();
+            if (pos >= _scan_node_buffer_size) {
                 //replace the last entry if buffer is full
-                operationalBuf->at(operationalBuf->size() - 1) = *hqNode;
+                operationalBuf->nodes.back() = *hqNode;
+                --pos;
             }
             else {
-                operationalBuf->push_back(*hqNode);
+                operationalBuf->nodes.push_back(*hqNode);
             }
 
-        }
+            LidarScanFrame& frame = operationalBuf->frame;
+            frame.getAngles_q14()[pos] = hqNode->angle_z_q14;
+            frame.getDistances_q2()[pos] = hqNode->dist_mm_q2;
+            frame.getQualities()[pos] = hqNode->quality;
+            frame.getFlags()[pos] = hqNode->flag;
+            frame.getTimestampOffsets_uS()[pos] = _getTimestampOffset(frame.begin_timestamp_uS, currentSampleTsUs);
+            frame.count = operationalBuf->nodes.size();
+            frame.end_timestamp_uS = currentSampleTsUs;
 
-        void rewindCurrentScanData() {
-            rp::hal::AutoLocker l(_locker);
-            _getOperationalBuffer_locked().clear();
+            if (operationalBuf->deskew.provider) {
+                _deskewSample(*operationalBuf, pos, currentSampleTsUs);
+            }
         }
 
-        std::vector<T>* waitAndLockAvailableScan(_u32 timeout, _u64 * out_timestamp_uS = nullptr)
+        void _beginDeskew(ScanBuffer& buffer, _u64 beginTsUs)
         {
-            if (_data_waiter.wait(timeout) == rp::hal::Event::EVENT_OK)
-            {
-                _locker.lock();
-                assert(_scan_node_available_id >= 0);
-                _new_scan_ready = false;
-                if (out_timestamp_uS) {
-                    *out_timestamp_uS = _scan_begin_timestamp_uS[_scan_node_available_id];
-                }
-                return &_scanbuffer[_scan_node_available_id];
+            DeskewState& deskew = buffer.deskew;
+            deskew.provider = _pose_provider;
+            if (!deskew.provider) return;
+
+            if (!deskew.provider->getPoseAt(beginTsUs, deskew.begin_pose)) {
+                deskew.provider = nullptr;
+                return;
             }
-            else {
-                return nullptr;
+            deskew.begin_cos_yaw = cos(deskew.begin_pose.yaw);
+            deskew.begin_sin_yaw = sin(deskew.begin_pose.yaw);
+
+            if (deskew.x.size() < _scan_node_buffer_size) {
+                deskew.x.resize(_scan_node_buffer_size);
+                deskew.y.resize(_scan_node_buffer_size);
             }
         }
 
-        void unlockScan(std::vector<T>* scan) {
-            if (scan) {
-                _locker.unlock();
-            }
+        // the transform from the LIDAR frame at the given pose into the one at the beginning of the scan
+        static void _getRelativeTransform(const DeskewState& deskew, const LidarPose2D& pose, double& tx, double& ty, double& yaw)
+        {
+            double dx = pose.x - deskew.begin_pose.x;
+            double dy = pose.y - deskew.begin_pose.y;
+            tx = deskew.begin_cos_yaw * dx + deskew.begin_sin_yaw * dy;
+            ty = -deskew.begin_sin_yaw * dx + deskew.begin_cos_yaw * dy;
+            yaw = pose.yaw - deskew.begin_pose.yaw;
         }
 
-    protected:
-        int _finishCurrentScanAndSwap_locked() {
-            _scan_node_available_id = _getOperationBufferID_locked();
-            int newOperationalID  =  1 - _scan_node_available_id;
+        void _deskewSample(ScanBuffer& buffer, size_t pos, _u64 sampleTsUs)
+        {
+            DeskewState& deskew = buffer.deskew;
+            const T& node = buffer.nodes[pos];
+            if (!node.dist_mm_q2) return;
+
+            LidarPose2D pose;
+            if (!deskew.provider->getPoseAt(sampleTsUs, pose)) {
+                // leave the whole scan uncompensated
+                deskew.provider = nullptr;
+                return;
+            }
 
-            _scanbuffer[newOperationalID].clear();
-            return newOperationalID;
+            double tx, ty, yaw;
+            _getRelativeTransform(deskew, pose, tx, ty, yaw);
+
+            // the LIDAR angle grows clockwise
+            double angle = node.angle_z_q14 * ANGLE_Q14_TO_RAD;
+            double dist = node.dist_mm_q2 / 4.0;
+            double localX = dist * cos(angle);
+            double localY = -dist * sin(angle);
+
+            double c = cos(yaw), s = sin(yaw);
+            deskew.x[pos] = (float)(c * localX - s * localY + tx);
+            deskew.y[pos] = (float)(s * localX + c * localY + ty);
         }
 
-        int _getOperationBufferID_locked() {
-            if (_scan_node_available_id < 0) return 0;
-            return 1 - _scan_node_available_id;
+        // move the samples from the scan begin frame into the frame at the last sample
+        void _finishDeskew(ScanBuffer& buffer)
+        {
+            DeskewState& deskew = buffer.deskew;
+            LidarScanFrame& frame = buffer.frame;
+
+            LidarPose2D endPose;
+            if (!deskew.provider->getPoseAt(frame.end_timestamp_uS, endPose)) return;
+
+            double tx, ty, yaw;
+            _getRelativeTransform(deskew, endPose, tx, ty, yaw);
+            double c = cos(yaw), s = sin(yaw);
+
+            for (size_t pos = 0; pos < buffer.nodes.size(); ++pos) {
+                T& node = buffer.nodes[pos];
+                if (!node.dist_mm_q2) continue;
+
+                double bx = deskew.x[pos] - tx;
+                double by = deskew.y[pos] - ty;
+                double ex = c * bx + s * by;
+                double ey = -s * bx + c * by;
+
+                double angle = atan2(-ey, ex);
+                if (angle < 0) angle += 2 * PI;
+
+                node.angle_z_q14 = (sl_u16)((sl_u32)(angle / ANGLE_Q14_TO_RAD + 0.5) & 0xFFFF);
+                node.dist_mm_q2 = (sl_u32)(sqrt(ex * ex + ey * ey) * 4 + 0.5);
+                frame.getAngles_q14()[pos] = node.angle_z_q14;
+                frame.getDistances_q2()[pos] = node.dist_mm_q2;
+            }
+            frame.motion_compensated = true;
         }
 
-        std::vector<T>& _getOperationalBuffer_locked()
+        static sl_s32 _getTimestampOffset(_u64 beginTsUs, _u64 sampleTsUs)
         {
-            return _scanbuffer[_getOperationBufferID_locked()];
+            // a scan lasts far less than the range of the offset, only a clock jump can exceed it
+            sl_s64 offset = (sl_s64)(sampleTsUs - beginTsUs);
+            if (offset > INT32_MAX) return INT32_MAX;
+            if (offset < INT32_MIN) return INT32_MIN;
+            return (sl_s32)offset;
+        }
+
+        ScanBuffer* _finishCurrentScanAndSwap_locked() {
+            ScanBuffer& finishedBuf = _getBuffer(_write_id);
+            finishedBuf.frame.scan_sequence = ++_scan_sequence;
+            if (finishedBuf.deskew.provider) {
+                _finishDeskew(finishedBuf);
+            }
+
+            ILidarSampleSink* sink = _sample_sink;
+            if (sink) {
+                // the buffer is still owned by the producer here
+                sink->onScanCompleted(&finishedBuf.nodes[0], finishedBuf.nodes.size(), finishedBuf.frame.begin_timestamp_uS, finishedBuf.frame.scan_sequence);
+            }
+
+            _history.push(finishedBuf.frame);
+
+            _write_id = _middle_id.exchange(_write_id | BUFFER_DIRTY_FLAG) & BUFFER_INDEX_MASK;
+
+            ScanBuffer* newOperationalBuf = &_getBuffer(_write_id);
+            newOperationalBuf->clear();
+            return newOperationalBuf;
         }
 
 
+        // serializes the producer side operations (push/rewind) against reset()
         rp::hal::Locker _locker;
         rp::hal::Event  _data_waiter;
 
         
 
-        _u64   _scan_begin_timestamp_uS[2];
         size_t _scan_node_buffer_size;
-        int    _scan_node_available_id;
+        std::shared_ptr<ScanBufferPool> _pool;
+        int    _write_id;    // owned by the producer
+        int    _read_id;     // owned by the consumer
+        std::atomic<int>    _middle_id;
+        _u64   _scan_sequence;
         std::atomic<bool>   _new_scan_ready;
+        std::atomic<ILidarSampleSink*> _sample_sink;
+        std::atomic<ILidarPoseProvider*> _pose_provider;
+        ScanHistoryRing _history;
+    };
+
+    // Publishes partial scans (sectors) as soon as they are complete, so the consumer
+    // does not have to wait for the end of the revolution.
+    template<typename T>
+    class ScanSectorHolder
+    {
+    public:
+        ScanSectorHolder(size_t maxcount = 8192)
+            : _max_count(maxcount)
+            , _enabled(false)
+            , _sector_angle_q14(0)
+            , _sector_sample_count(0)
+            , _current_sector_index(0)
+            , _begin_timestamp_uS(0)
+            , _sector_sequence(0)
+            , _ready_begin_timestamp_uS(0)
+            , _ready_sequence(0)
+            , _new_sector_ready(false)
+            , _sample_sink(nullptr)
+        {
+            _write_nodes.reserve(maxcount);
+            _ready_nodes.reserve(maxcount);
+        }
+
+        void configure(_u32 sectorAngle_q14, _u32 sectorSampleCount)
+        {
+            rp::hal::AutoLocker l(_locker);
+            _sector_angle_q14 = sectorAngle_q14;
+            _sector_sample_count = sectorSampleCount;
+            _write_nodes.clear();
+            _enabled = (sectorAngle_q14 || sectorSampleCount);
+        }
+
+        void reset()
+        {
+            rp::hal::AutoLocker l(_locker);
+            _write_nodes.clear();
+            _new_sector_ready = false;
+            _data_waiter.set(false);
+        }
+
+        void setSampleSink(ILidarSampleSink* sink)
+        {
+            _sample_sink = sink;
+        }
+
+        void pushNodes(const _u64* sampleTsUs, const T* nodes, size_t count)
+        {
+            if (!_enabled) return;
+
+            rp::hal::AutoLocker l(_locker);
+            for (size_t pos = 0; pos < count; ++pos) {
+                _pushNode_locked(sampleTsUs[pos], nodes[pos]);
+            }
+        }
+
+        sl_result waitAndFetch(T* nodebuffer, size_t& count, _u64& timestamp_uS, _u64& sequence, _u32 timeout)
+        {
+            _u64 deadline = getms() + timeout;
+            while (true) {
+                {
+                    rp::hal::AutoLocker l(_locker);
+                    if (_new_sector_ready) {
+                        count = std::min<size_t>(count, _ready_nodes.size());
+                        std::copy(_ready_nodes.begin(), _ready_nodes.begin() + count, nodebuffer);
+                        timestamp_uS = _ready_begin_timestamp_uS;
+                        sequence = _ready_sequence;
+                        _new_sector_ready = false;
+                        return SL_RESULT_OK;
+                    }
+                }
+
+                _u64 currentTs = getms();
+                if (currentTs >= deadline) return SL_RESULT_OPERATION_TIMEOUT;
+                if (_data_waiter.wait((_u32)(deadline - currentTs)) == rp::hal::Event::EVENT_FAILED) return SL_RESULT_OPERATION_FAIL;
+            }
+        }
+
+    protected:
+        _u32 _getSectorIndex(const T& node) const
+        {
+            return node.angle_z_q14 / _sector_angle_q14;
+        }
+
+        void _pushNode_locked(_u64 sampleTsUs, const T& node)
+        {
+            if (!_write_nodes.empty()) {
+                bool sectorDone = (node.flag & RPLIDAR_RESP_HQ_FLAG_SYNCBIT) != 0;
+
+                if (!sectorDone && _sector_angle_q14) {
+                    // only a forward step closes the sector, a sample jittering back stays in the current one
+                    _u32 sectorCount = (65536 + _sector_angle_q14 - 1) / _sector_angle_q14;
+                    _u32 step = (_getSectorIndex(node) + sectorCount - _current_sector_index) % sectorCount;
+                    sectorDone = (step && step <= sectorCount / 2);
+                }
 
-        std::vector<T> _scanbuffer[2];
+                if (sectorDone) _publish_locked();
+            }
+
+            if (_write_nodes.empty()) {
+                _begin_timestamp_uS = sampleTsUs;
+                if (_sector_angle_q14) _current_sector_index = _getSectorIndex(node);
+            }
+
+            if (_write_nodes.size() < _max_count) {
+                _write_nodes.push_back(node);
+            }
+
+            if (_sector_sample_count && _write_nodes.size() >= _sector_sample_count) {
+                _publish_locked();
+            }
+        }
+
+        void _publish_locked()
+        {
+            ++_sector_sequence;
+
+            ILidarSampleSink* sink = _sample_sink;
+            if (sink) {
+                sink->onScanSectorCompleted(&_write_nodes[0], _write_nodes.size(), _begin_timestamp_uS, _sector_sequence);
+            }
+
+            _ready_nodes.swap(_write_nodes);
+            _write_nodes.clear();
+            _ready_begin_timestamp_uS = _begin_timestamp_uS;
+            _ready_sequence = _sector_sequence;
+            _new_sector_ready = true;
+            _data_waiter.set();
+        }
+
+        rp::hal::Locker _locker;
+        rp::hal::Event  _data_waiter;
+
+        size_t            _max_count;
+        std::atomic<bool> _enabled;
+        _u32              _sector_angle_q14;
+        _u32              _sector_sample_count;
+
+        // the sector being received, owned by the producer
+        std::vector<T>    _write_nodes;
+        _u32              _current_sector_index;
+        _u64              _begin_timestamp_uS;
+        _u64              _sector_sequence;
+
+        // the latest completed sector
+        std::vector<T>    _ready_nodes;
+        _u64              _ready_begin_timestamp_uS;
+        _u64              _ready_sequence;
+        bool              _new_sector_ready;
+
+        std::atomic<ILidarSampleSink*> _sample_sink;
     };
 
     class SlamtecLidarDriver : 
@@ -397,11 +1136,14 @@ namespace sl {
     public:
         SlamtecLidarDriver()
             : _isConnected(false)
+            , _bindFlags(0)
             , _isSupportingMotorCtrl(MotorCtrlSupportNone)
             , _op_locker(true)
             , _scanHolder(MAX_SCANNODE_CACHE_COUNT)
             , _rawSampleNodeHolder(MAX_SCANNODE_CACHE_COUNT)
+            , _sectorHolder(MAX_SCANNODE_CACHE_COUNT)
             , _waiting_packet_type(0)
+            , _sample_sink(nullptr)
         {
             _protocolHandler = std::make_shared< internal::RPLidarProtocolCodec>();
             _transeiver = std::make_shared< internal::AsyncTransceiver>(*_protocolHandler);
@@ -471,6 +1213,11 @@ namespace sl {
         }
 
         sl_result connect(IChannel* channel)
+        {
+            return connect(channel, 0);
+        }
+
+        sl_result connect(IChannel* channel, sl_u32 flags)
         {
             rp::hal::AutoLocker l(_op_locker);
             if (!channel) return SL_RESULT_OPERATION_FAIL;
@@ -480,8 +1227,12 @@ namespace sl {
 
             sl_result ans;
             
+            _bindFlags = 0;
+            if (flags & CONNECT_FLAG_SINGLE_THREAD) {
+                _bindFlags |= internal::AsyncTransceiver::BIND_FLAG_SINGLE_THREAD;
+            }
        
-            ans = (sl_result)_transeiver->openChannelAndBind(channel);
+            ans = (sl_result)_transeiver->openChannelAndBind(channel, _bindFlags);
 
             if (IS_OK(ans)) {
                 _isConnected = true;
@@ -653,6 +1404,7 @@ namespace sl {
             startMotor();
 
             _scanHolder.reset();
+            _sectorHolder.reset();
             _dataunpacker->enable();
 
             ans = _sendCommandWithoutResponse(force ? SL_LIDAR_CMD_FORCE_SCAN : SL_LIDAR_CMD_SCAN, nullptr, 0, true);
@@ -740,6 +1492,7 @@ namespace sl {
             startMotor();
 
             _scanHolder.reset();
+            _sectorHolder.reset();
             _dataunpacker->enable();
 
             sl_lidar_payload_express_scan_t scanReq;
@@ -787,14 +1540,32 @@ namespace sl {
             if (!nodebuffer)
                 return SL_RESULT_INVALID_DATA;
 
-            auto availBuffer = _scanHolder.waitAndLockAvailableScan(timeout, &timestamp_uS);
+            auto availBuffer = _scanHolder.waitForLatestScan(timeout);
             if (!availBuffer) return SL_RESULT_OPERATION_TIMEOUT;
 
-            count = std::min<size_t>(count, availBuffer->size());
+            timestamp_uS = availBuffer->frame.begin_timestamp_uS;
+            count = std::min<size_t>(count, availBuffer->nodes.size());
+
+            std::copy(availBuffer->nodes.begin(), availBuffer->nodes.begin() + count, nodebuffer);
+
+            return RESULT_OK;
+        }
+
+        sl_result grabScanDataHqWithSampleTimeStamps(sl_lidar_response_measurement_node_hq_t* nodebuffer, sl_s32* timestampOffsets_uS, size_t& count, sl_u64& timestamp_uS, sl_u32 timeout = DEFAULT_TIMEOUT)
+        {
+            rp::hal::AutoLocker l(_op_locker);
 
-            std::copy(availBuffer->begin(), availBuffer->begin() + count, nodebuffer);
+            if (!nodebuffer || !timestampOffsets_uS)
+                return SL_RESULT_INVALID_DATA;
 
-            _scanHolder.unlockScan(availBuffer);
+            auto availBuffer = _scanHolder.waitForLatestScan(timeout);
+            if (!availBuffer) return SL_RESULT_OPERATION_TIMEOUT;
+
+            timestamp_uS = availBuffer->frame.begin_timestamp_uS;
+            count = std::min<size_t>(count, availBuffer->nodes.size());
+
+            std::copy(availBuffer->nodes.begin(), availBuffer->nodes.begin() + count, nodebuffer);
+            memcpy(timestampOffsets_uS, availBuffer->frame.getTimestampOffsets_uS(), count * sizeof(sl_s32));
 
             return RESULT_OK;
         }
@@ -805,6 +1576,23 @@ namespace sl {
             return grabScanDataHqWithTimeStamp(nodebuffer, count, localTS, timeout);
         }
 
+        sl_result grabScanDataLease(LidarScanLeasePtr& outLease, sl_u32 timeout = DEFAULT_TIMEOUT)
+        {
+            rp::hal::AutoLocker l(_op_locker);
+            return _scanHolder.waitAndLeaseLatestScan(outLease, timeout);
+        }
+
+        sl_result grabScanFrame(LidarScanFrame& frame, sl_u32 timeout = DEFAULT_TIMEOUT)
+        {
+            rp::hal::AutoLocker l(_op_locker);
+
+            auto availBuffer = _scanHolder.waitForLatestScan(timeout);
+            if (!availBuffer) return SL_RESULT_OPERATION_TIMEOUT;
+
+            if (!frame.copyFrom(availBuffer->frame)) return SL_RESULT_INSUFFICIENT_MEMORY;
+            return SL_RESULT_OK;
+        }
+
         sl_result getDeviceInfo(sl_lidar_response_device_info_t& info, sl_u32 timeout = DEFAULT_TIMEOUT)
         {
             rp::hal::AutoLocker l(_op_locker);
@@ -965,6 +1753,58 @@ namespace sl {
             return SL_RESULT_OK;
         }
 
+        sl_u64 getDroppedIntervalSampleCount()
+        {
+            return _rawSampleNodeHolder.getDroppedCount();
+        }
+
+        sl_result setSampleSink(ILidarSampleSink* sink)
+        {
+            _sample_sink = sink;
+            _scanHolder.setSampleSink(sink);
+            _sectorHolder.setSampleSink(sink);
+            return SL_RESULT_OK;
+        }
+
+        sl_result setPoseProvider(ILidarPoseProvider* provider)
+        {
+            _scanHolder.setPoseProvider(provider);
+            return SL_RESULT_OK;
+        }
+
+        sl_result setScanHistoryDepth(size_t depth)
+        {
+            return _scanHolder.setHistoryDepth(depth);
+        }
+
+        sl_result grabNextHistoryScan(LidarScanFrame& frame, sl_u32 timeout = DEFAULT_TIMEOUT)
+        {
+            // the history has its own lock, fetching from it must not wait behind the live scan consumers
+            return _scanHolder.getHistory().waitAndFetch(frame, timeout);
+        }
+
+        sl_u64 getDroppedHistoryScanCount()
+        {
+            return _scanHolder.getHistory().getDroppedCount();
+        }
+
+        sl_result setScanSectorMode(sl_u32 sectorAngle_q14, sl_u32 sectorSampleCount)
+        {
+            if (sectorAngle_q14 > 65536) return SL_RESULT_INVALID_DATA;
+
+            _sectorHolder.configure(sectorAngle_q14, sectorSampleCount);
+            return SL_RESULT_OK;
+        }
+
+        sl_result grabScanSectorHq(sl_lidar_response_measurement_node_hq_t* nodebuffer, size_t& count, sl_u64& timestamp_uS, sl_u64& sectorSequence, sl_u32 timeout = DEFAULT_TIMEOUT)
+        {
+            // the sector holder has its own lock, a sector consumer must not wait behind a full scan one
+            if (!nodebuffer)
+                return SL_RESULT_INVALID_DATA;
+
+            return _sectorHolder.waitAndFetch(nodebuffer, count, timestamp_uS, sectorSequence, timeout);
+        }
+
         sl_result setMotorSpeed(sl_u16 speed = DEFAULT_MOTOR_SPEED)
         {
             rp::hal::AutoLocker l(_op_locker);
@@ -1132,7 +1972,7 @@ namespace sl {
 
                     cachedChannel->close();
                     // restart the transiever 
-                    ans = _transeiver->openChannelAndBind(cachedChannel);
+                    ans = _transeiver->openChannelAndBind(cachedChannel, _bindFlags);
                     if (IS_FAIL(ans)) return ans;
 
 
@@ -1149,7 +1989,7 @@ namespace sl {
                 }
             } while (0);
 
-            _transeiver->openChannelAndBind(cachedChannel);
+            _transeiver->openChannelAndBind(cachedChannel, _bindFlags);
 
             return ans;
         }
@@ -1644,24 +2484,42 @@ namespace sl {
 
         virtual void onHQNodeDecoded(_u64 timestamp_uS, const rplidar_response_measurement_node_hq_t* node)
         {
+            ILidarSampleSink* sink = _sample_sink;
+            if (sink) {
+                sink->onSamplesDecoded(node, &timestamp_uS, 1);
+            }
+
             _scanHolder.pushScanNodeData(timestamp_uS, node);
+            _sectorHolder.pushNodes(&timestamp_uS, node, 1);
             _rawSampleNodeHolder.pushNode(timestamp_uS, node);
         }
 
+        virtual void onHQNodesDecoded(const rplidar_response_measurement_node_hq_t* nodes, const _u64* timestamp_uS, size_t count)
+        {
+            ILidarSampleSink* sink = _sample_sink;
+            if (sink) {
+                sink->onSamplesDecoded(nodes, timestamp_uS, count);
+            }
+
+            _scanHolder.pushScanNodesData(timestamp_uS, nodes, count);
+            _sectorHolder.pushNodes(timestamp_uS, nodes, count);
+            _rawSampleNodeHolder.pushNodes(timestamp_uS, nodes, count);
+        }
+
         virtual void onHQNodeScanResetReq() {
             _scanHolder.rewindCurrentScanData();
         }
 
         virtual void onProtocolMessageDecoded(const internal::ProtocolMessage& msg)
         {
-            internal::message_autoptr_t message = std::make_shared<internal::ProtocolMessage>(msg);
-
-            if (_dataunpacker->onSampleData(message->cmd, message->getDataBuf(), message->getPayloadSize()))
+            if (_dataunpacker->onSampleData(msg.cmd, msg.getDataBuf(), msg.getPayloadSize(), _transeiver->getDecodingRxTimestamp_uS()))
             {
                 return;
             }
 
-            if (message->cmd == _waiting_packet_type) {
+            if (msg.cmd == _waiting_packet_type) {
+                // only the command responses need to outlive the decoding buffer
+                internal::message_autoptr_t message = std::make_shared<internal::ProtocolMessage>(msg);
                 _data_locker.lock();
                 _lastAnsPkt = message;
                 _response_waiter.setResult(message->cmd);
@@ -1670,6 +2528,12 @@ namespace sl {
 
             
         }
+
+        virtual bool onLoopModePayloadDecoded(_u8 type, const _u8* payload, size_t size)
+        {
+            // sample data is decoded straight from the rx buffer
+            return _dataunpacker->onSampleData(type, payload, size, _transeiver->getDecodingRxTimestamp_uS());
+        }
     private:
 
         std::shared_ptr<internal::RPLidarProtocolCodec> _protocolHandler;
@@ -1677,6 +2541,7 @@ namespace sl {
         std::shared_ptr<internal::LIDARSampleDataUnpacker> _dataunpacker;
 
         bool _isConnected;
+        _u32 _bindFlags;
 
         MotorCtrlSupport          _isSupportingMotorCtrl;
 
@@ -1687,12 +2552,15 @@ namespace sl {
 
         ScanDataHolder<sl_lidar_response_measurement_node_hq_t> _scanHolder;
         RawSampleNodeHolder<sl_lidar_response_measurement_node_hq_t> _rawSampleNodeHolder;
+        ScanSectorHolder<sl_lidar_response_measurement_node_hq_t> _sectorHolder;
         _u32                          _waiting_packet_type;
         internal::message_autoptr_t   _lastAnsPkt;
 
         sl_lidar_response_device_info_t _cached_DevInfo;
         SlamtecLidarTimingDesc         _timing_desc;
 
+        std::atomic<ILidarSampleSink*> _sample_sink;
+
     };
 
     Result<ILidarDriver*> createLidarDriver()
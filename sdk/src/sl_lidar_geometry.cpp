@@ -0,0 +1,357 @@
+/*
+ * Slamtec LIDAR SDK
+ *
+ *  Copyright (c) 2014 - 2020 Shanghai Slamtec Co., Ltd.
+ *  http://www.slamtec.com
+ *
+ */
+ /*
+  * Redistribution and use in source and binary forms, with or without
+  * modification, are permitted provided that the following conditions are met:
+  *
+  * 1. Redistributions of source code must retain the above copyright notice,
+  *    this list of conditions and the following disclaimer.
+  *
+  * 2. Redistributions in binary form must reproduce the above copyright notice,
+  *    this list of conditions and the following disclaimer in the documentation
+  *    and/or other materials provided with the distribution.
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+  * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+  * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+  * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+  * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+  * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+  * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+  * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+  * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  */
+
+#include "sl_lidar_geometry.h"
+#include "sl_lidar_geometry_internal.h"
+#include <math.h>
+
+// the vectorized paths read the packed nodes as pairs of little endian dwords
+#ifndef _CPU_ENDIAN_BIG
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#   if defined(__SSE2__)
+#       define SL_GEOMETRY_HAS_SSE
+#   endif
+#   define SL_GEOMETRY_HAS_AVX2
+#   define SL_GEOMETRY_AVX2_TARGET __attribute__((target("avx2")))
+#   include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#   if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#       define SL_GEOMETRY_HAS_SSE
+#   endif
+#   define SL_GEOMETRY_HAS_AVX2
+#   define SL_GEOMETRY_AVX2_TARGET
+#   include <intrin.h>
+#   include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#   define SL_GEOMETRY_HAS_NEON
+#   include <arm_neon.h>
+#endif
+
+#endif
+
+namespace sl { namespace geometry {
+
+    // angle_z_q14 uses 1 << 14 steps per quadrant
+    static const sl_u32 QUADRANT_STEPS = 1 << 14;
+    static const sl_u32 QUADRANT_MASK = QUADRANT_STEPS - 1;
+    static const double HALF_PI = 1.57079632679489661923;
+
+    // sin() of one quadrant sampled at every q14 step, cos(a) is looked up as sin(90deg - a)
+    struct SinTable {
+        float value[QUADRANT_STEPS + 1];
+
+        SinTable()
+        {
+            for (sl_u32 i = 0; i <= QUADRANT_STEPS; ++i) {
+                value[i] = (float)sin(i * HALF_PI / QUADRANT_STEPS);
+            }
+        }
+    };
+
+    static const float* _getSinTable()
+    {
+        // thread-safe one time initialization
+        static const SinTable table;
+        return table.value;
+    }
+
+    typedef void (*table_convert_proc_t)(const float* sinTable, const sl_lidar_response_measurement_node_hq_t* nodes, size_t count, float* x, float* y, float* intensity);
+
+    // In odd quadrants sin and cos swap their roles, so the table index of the sine is mirrored.
+    // The sign of cos is negative in quadrant 1 and 2, the sign of sin in quadrant 2 and 3.
+    static inline void _convertNode(const float* sinTable, const sl_lidar_response_measurement_node_hq_t& node, float& x, float& y)
+    {
+        sl_u32 quadrant = node.angle_z_q14 >> 14;
+        sl_u32 sinIndex = node.angle_z_q14 & QUADRANT_MASK;
+        if (quadrant & 1) sinIndex = QUADRANT_STEPS - sinIndex;
+
+        float sinValue = sinTable[sinIndex];
+        float cosValue = sinTable[QUADRANT_STEPS - sinIndex];
+        if ((quadrant + 1) & 2) cosValue = -cosValue;
+        if (quadrant & 2) sinValue = -sinValue;
+
+        float dist = (float)node.dist_mm_q2 * 0.25f;
+        x = dist * cosValue;
+        y = dist * sinValue;
+    }
+
+    static void _convertScalar(const float* sinTable, const sl_lidar_response_measurement_node_hq_t* nodes, size_t count, float* x, float* y, float* intensity)
+    {
+        for (size_t pos = 0; pos < count; ++pos) {
+            _convertNode(sinTable, nodes[pos], x[pos], y[pos]);
+        }
+        if (intensity) {
+            for (size_t pos = 0; pos < count; ++pos) {
+                intensity[pos] = (float)nodes[pos].quality;
+            }
+        }
+    }
+
+#ifdef SL_GEOMETRY_HAS_SSE
+    // each node is two dwords: [angle | dist_lo << 16] [dist_hi | quality << 16 | flag << 24]
+    static void _convertSSE(const float* sinTable, const sl_lidar_response_measurement_node_hq_t* nodes, size_t count, float* x, float* y, float* intensity)
+    {
+        const __m128i lowWordMask = _mm_set1_epi32(0xFFFF);
+        const __m128i indexMask = _mm_set1_epi32(QUADRANT_MASK);
+        const __m128i byteMask = _mm_set1_epi32(0xFF);
+        const __m128i one = _mm_set1_epi32(1);
+        const __m128i two = _mm_set1_epi32(2);
+        const __m128i quadrantSteps = _mm_set1_epi32(QUADRANT_STEPS);
+        const __m128 distScale = _mm_set1_ps(0.25f);
+
+        size_t pos = 0;
+        for (; pos + 4 <= count; pos += 4) {
+            const __m128 lo = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(nodes + pos)));
+            const __m128 hi = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(nodes + pos + 2)));
+            const __m128i dw0 = _mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));
+            const __m128i dw1 = _mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)));
+
+            __m128i angle = _mm_and_si128(dw0, lowWordMask);
+            __m128i dist = _mm_or_si128(_mm_srli_epi32(dw0, 16), _mm_slli_epi32(dw1, 16));
+            __m128i quadrant = _mm_srli_epi32(angle, 14);
+
+            // sinIndex = odd ? QUADRANT_STEPS - index : index
+            __m128i odd = _mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one);
+            __m128i sinIndex = _mm_and_si128(angle, indexMask);
+            sinIndex = _mm_sub_epi32(_mm_xor_si128(sinIndex, odd), odd);
+            sinIndex = _mm_add_epi32(sinIndex, _mm_and_si128(odd, quadrantSteps));
+
+            sl_u32 idx[4];
+            _mm_storeu_si128((__m128i*)idx, sinIndex);
+            __m128 sinValue = _mm_setr_ps(sinTable[idx[0]], sinTable[idx[1]], sinTable[idx[2]], sinTable[idx[3]]);
+            __m128 cosValue = _mm_setr_ps(sinTable[QUADRANT_STEPS - idx[0]], sinTable[QUADRANT_STEPS - idx[1]],
+                sinTable[QUADRANT_STEPS - idx[2]], sinTable[QUADRANT_STEPS - idx[3]]);
+
+            __m128i cosSign = _mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), 30);
+            __m128i sinSign = _mm_slli_epi32(_mm_and_si128(quadrant, two), 30);
+            cosValue = _mm_xor_ps(cosValue, _mm_castsi128_ps(cosSign));
+            sinValue = _mm_xor_ps(sinValue, _mm_castsi128_ps(sinSign));
+
+            // signed conversion, no real measurement comes close to 2^31 in q2
+            __m128 distValue = _mm_mul_ps(_mm_cvtepi32_ps(dist), distScale);
+            _mm_storeu_ps(x + pos, _mm_mul_ps(distValue, cosValue));
+            _mm_storeu_ps(y + pos, _mm_mul_ps(distValue, sinValue));
+            if (intensity) {
+                __m128i quality = _mm_and_si128(_mm_srli_epi32(dw1, 16), byteMask);
+                _mm_storeu_ps(intensity + pos, _mm_cvtepi32_ps(quality));
+            }
+        }
+
+        _convertScalar(sinTable, nodes + pos, count - pos, x + pos, y + pos, intensity ? intensity + pos : NULL);
+    }
+#endif
+
+#ifdef SL_GEOMETRY_HAS_AVX2
+    SL_GEOMETRY_AVX2_TARGET
+    static void _convertAVX2(const float* sinTable, const sl_lidar_response_measurement_node_hq_t* nodes, size_t count, float* x, float* y, float* intensity)
+    {
+        const __m256i lowWordMask = _mm256_set1_epi32(0xFFFF);
+        const __m256i indexMask = _mm256_set1_epi32(QUADRANT_MASK);
+        const __m256i byteMask = _mm256_set1_epi32(0xFF);
+        const __m256i one = _mm256_set1_epi32(1);
+        const __m256i two = _mm256_set1_epi32(2);
+        const __m256i quadrantSteps = _mm256_set1_epi32(QUADRANT_STEPS);
+        const __m256 distScale = _mm256_set1_ps(0.25f);
+
+        size_t pos = 0;
+        for (; pos + 8 <= count; pos += 8) {
+            const __m256 lo = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i*)(nodes + pos)));
+            const __m256 hi = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i*)(nodes + pos + 4)));
+            // the in-lane shuffle yields the node order 0 1 4 5 2 3 6 7, the permute restores it
+            const __m256i dw0 = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0));
+            const __m256i dw1 = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0));
+
+            __m256i angle = _mm256_and_si256(dw0, lowWordMask);
+            __m256i dist = _mm256_or_si256(_mm256_srli_epi32(dw0, 16), _mm256_slli_epi32(dw1, 16));
+            __m256i quadrant = _mm256_srli_epi32(angle, 14);
+
+            // sinIndex = odd ? QUADRANT_STEPS - index : index
+            // plain integer arithmetic as in _convertSSE: with -funsigned-char, GCC mis-evaluates
+            // _mm256_blendv_epi8 on this mask and the odd quadrants are not mirrored
+            __m256i odd = _mm256_cmpeq_epi32(_mm256_and_si256(quadrant, one), one);
+            __m256i sinIndex = _mm256_and_si256(angle, indexMask);
+            sinIndex = _mm256_sub_epi32(_mm256_xor_si256(sinIndex, odd), odd);
+            sinIndex = _mm256_add_epi32(sinIndex, _mm256_and_si256(odd, quadrantSteps));
+            __m256i cosIndex = _mm256_sub_epi32(quadrantSteps, sinIndex);
+
+            __m256 sinValue = _mm256_i32gather_ps(sinTable, sinIndex, 4);
+            __m256 cosValue = _mm256_i32gather_ps(sinTable, cosIndex, 4);
+
+            __m256i cosSign = _mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(quadrant, one), two), 30);
+            __m256i sinSign = _mm256_slli_epi32(_mm256_and_si256(quadrant, two), 30);
+            cosValue = _mm256_xor_ps(cosValue, _mm256_castsi256_ps(cosSign));
+            sinValue = _mm256_xor_ps(sinValue, _mm256_castsi256_ps(sinSign));
+
+            __m256 distValue = _mm256_mul_ps(_mm256_cvtepi32_ps(dist), distScale);
+            _mm256_storeu_ps(x + pos, _mm256_mul_ps(distValue, cosValue));
+            _mm256_storeu_ps(y + pos, _mm256_mul_ps(distValue, sinValue));
+            if (intensity) {
+                __m256i quality = _mm256_and_si256(_mm256_srli_epi32(dw1, 16), byteMask);
+                _mm256_storeu_ps(intensity + pos, _mm256_cvtepi32_ps(quality));
+            }
+        }
+
+        _convertScalar(sinTable, nodes + pos, count - pos, x + pos, y + pos, intensity ? intensity + pos : NULL);
+    }
+
+    static bool _cpuSupportsAVX2()
+    {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        // ecx bit 27: OSXSAVE, bit 28: AVX
+        if (!(info[2] & (1 << 27)) || !(info[2] & (1 << 28))) return false;
+        // the OS must save the ymm registers
+        if ((_xgetbv(0) & 0x6) != 0x6) return false;
+        __cpuidex(info, 7, 0);
+        // ebx bit 5: AVX2
+        return (info[1] & (1 << 5)) != 0;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif
+
+#ifdef SL_GEOMETRY_HAS_NEON
+    static void _convertNEON(const float* sinTable, const sl_lidar_response_measurement_node_hq_t* nodes, size_t count, float* x, float* y, float* intensity)
+    {
+        const uint32x4_t lowWordMask = vdupq_n_u32(0xFFFF);
+        const uint32x4_t indexMask = vdupq_n_u32(QUADRANT_MASK);
+        const uint32x4_t byteMask = vdupq_n_u32(0xFF);
+        const uint32x4_t one = vdupq_n_u32(1);
+        const uint32x4_t two = vdupq_n_u32(2);
+        const uint32x4_t quadrantSteps = vdupq_n_u32(QUADRANT_STEPS);
+
+        size_t pos = 0;
+        for (; pos + 4 <= count; pos += 4) {
+            // the de-interleaving load splits the nodes into their first and second dword
+            const uint32x4x2_t dw = vld2q_u32((const uint32_t*)(nodes + pos));
+
+            uint32x4_t angle = vandq_u32(dw.val[0], lowWordMask);
+            uint32x4_t dist = vorrq_u32(vshrq_n_u32(dw.val[0], 16), vshlq_n_u32(dw.val[1], 16));
+            uint32x4_t quadrant = vshrq_n_u32(angle, 14);
+
+            uint32x4_t odd = vceqq_u32(vandq_u32(quadrant, one), one);
+            uint32x4_t index = vandq_u32(angle, indexMask);
+            uint32x4_t sinIndex = vbslq_u32(odd, vsubq_u32(quadrantSteps, index), index);
+
+            sl_u32 idx[4];
+            vst1q_u32(idx, sinIndex);
+            const float sinLane[4] = { sinTable[idx[0]], sinTable[idx[1]], sinTable[idx[2]], sinTable[idx[3]] };
+            const float cosLane[4] = { sinTable[QUADRANT_STEPS - idx[0]], sinTable[QUADRANT_STEPS - idx[1]],
+                sinTable[QUADRANT_STEPS - idx[2]], sinTable[QUADRANT_STEPS - idx[3]] };
+
+            uint32x4_t cosSign = vshlq_n_u32(vandq_u32(vaddq_u32(quadrant, one), two), 30);
+            uint32x4_t sinSign = vshlq_n_u32(vandq_u32(quadrant, two), 30);
+            float32x4_t cosValue = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vld1q_f32(cosLane)), cosSign));
+            float32x4_t sinValue = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vld1q_f32(sinLane)), sinSign));
+
+            float32x4_t distValue = vmulq_n_f32(vcvtq_f32_u32(dist), 0.25f);
+            vst1q_f32(x + pos, vmulq_f32(distValue, cosValue));
+            vst1q_f32(y + pos, vmulq_f32(distValue, sinValue));
+            if (intensity) {
+                uint32x4_t quality = vandq_u32(vshrq_n_u32(dw.val[1], 16), byteMask);
+                vst1q_f32(intensity + pos, vcvtq_f32_u32(quality));
+            }
+        }
+
+        _convertScalar(sinTable, nodes + pos, count - pos, x + pos, y + pos, intensity ? intensity + pos : NULL);
+    }
+#endif
+
+    static table_convert_proc_t _selectConvertProc()
+    {
+#ifdef SL_GEOMETRY_HAS_AVX2
+        if (_cpuSupportsAVX2()) return &_convertAVX2;
+#endif
+#if defined(SL_GEOMETRY_HAS_SSE)
+        return &_convertSSE;
+#elif defined(SL_GEOMETRY_HAS_NEON)
+        return &_convertNEON;
+#else
+        return &_convertScalar;
+#endif
+    }
+
+    namespace internal {
+        template <table_convert_proc_t Convert>
+        static void _convertWithTable(const sl_lidar_response_measurement_node_hq_t* nodes, size_t count, float* x, float* y, float* intensity)
+        {
+            Convert(_getSinTable(), nodes, count, x, y, intensity);
+        }
+
+        size_t getConvertVariants(ConvertVariant* variants, size_t maxCount)
+        {
+            size_t count = 0;
+            ConvertVariant candidates[4];
+
+            candidates[count].name = "scalar";
+            candidates[count++].convert = &_convertWithTable<_convertScalar>;
+#ifdef SL_GEOMETRY_HAS_SSE
+            candidates[count].name = "SSE2";
+            candidates[count++].convert = &_convertWithTable<_convertSSE>;
+#endif
+#ifdef SL_GEOMETRY_HAS_AVX2
+            if (_cpuSupportsAVX2()) {
+                candidates[count].name = "AVX2";
+                candidates[count++].convert = &_convertWithTable<_convertAVX2>;
+            }
+#endif
+#ifdef SL_GEOMETRY_HAS_NEON
+            candidates[count].name = "NEON";
+            candidates[count++].convert = &_convertWithTable<_convertNEON>;
+#endif
+            if (count > maxCount) count = maxCount;
+            for (size_t pos = 0; pos < count; ++pos) {
+                variants[pos] = candidates[pos];
+            }
+            return count;
+        }
+    }
+
+    void polarToCartesian(const sl_lidar_response_measurement_node_hq_t* nodes, size_t count, float* x, float* y, float* intensity)
+    {
+        // thread-safe one time selection
+        static const table_convert_proc_t convertProc = _selectConvertProc();
+        convertProc(_getSinTable(), nodes, count, x, y, intensity);
+    }
+
+    void polarToCartesianScalar(const sl_lidar_response_measurement_node_hq_t* nodes, size_t count, float* x, float* y, float* intensity)
+    {
+        _convertScalar(_getSinTable(), nodes, count, x, y, intensity);
+    }
+
+}}
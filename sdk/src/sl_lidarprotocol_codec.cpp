@@ -58,9 +58,9 @@ namespace sl { namespace internal {
 RPLidarProtocolCodec::RPLidarProtocolCodec()
     : IAsyncProtocolCodec()
     , _listener(NULL)
-    , _op_locker(true)
+    , _reset_requested(false)
 {
-    onDecodeReset();
+    _resetDecoder();
 }
 
 void RPLidarProtocolCodec::exitLoopMode() {
@@ -71,7 +71,6 @@ void RPLidarProtocolCodec::exitLoopMode() {
 
 void RPLidarProtocolCodec::setMessageListener(IProtocolMessageListener* listener)
 {
-    rp::hal::AutoLocker l(_op_locker);
     _listener = listener;
 }
 
@@ -130,7 +129,11 @@ void RPLidarProtocolCodec::onEncodeData(message_autoptr_t& message, _u8* buffer,
 }
 
 void   RPLidarProtocolCodec::onDecodeReset() {
-    rp::hal::AutoLocker autolock(_op_locker);
+    // the reset is performed by the decoder thread before it consumes more data
+    _reset_requested.store(true, std::memory_order_release);
+}
+
+void   RPLidarProtocolCodec::_resetDecoder() {
     // flush the pending data
     _decodingMessage.cleanData();
     // reset to initial state
@@ -141,13 +144,59 @@ void   RPLidarProtocolCodec::onDecodeReset() {
 
 void RPLidarProtocolCodec::onDecodeData(const void* buffer, size_t size)
 {
-    rp::hal::AutoLocker autolock(_op_locker);
-
     const _u8* data = reinterpret_cast<const _u8*>(buffer);
     const _u8* dataEnd = data + size;
 
 
     while (data != dataEnd) {
+
+        if (_reset_requested.load(std::memory_order_relaxed)
+            && _reset_requested.exchange(false, std::memory_order_acquire)) {
+            _resetDecoder();
+        }
+
+        if (_working_states == (STATUS_LOOP_MODE_FLAG | STATUS_RECV_PAYLOAD) && _rx_pos == 0) {
+            // zero-copy path: the whole payload is available in the rx buffer,
+            // try to hand it over in place
+            size_t payloadSize = _decodingMessage.getPayloadSize();
+            IProtocolMessageListener* cachedLister = _listener.load(std::memory_order_acquire);
+
+            if (cachedLister && (size_t)(dataEnd - data) >= payloadSize) {
+                if (cachedLister->onLoopModePayloadDecoded(_decodingMessage.cmd, data, payloadSize)) {
+                    data += payloadSize;
+                    continue;
+                }
+            }
+        }
+
+        if ((_working_states & ((_u32)STATUS_LOOP_MODE_FLAG - 1)) == STATUS_RECV_PAYLOAD) {
+            // payload bytes need no parsing, copy as much as possible in one shot
+            size_t payloadSize = _decodingMessage.getPayloadSize();
+            size_t copySize = std::min<size_t>(payloadSize - _rx_pos, dataEnd - data);
+
+            memcpy(_decodingMessage.getDataBuf() + _rx_pos, data, copySize);
+            data += copySize;
+            _rx_pos += (int)copySize;
+
+            if ((size_t)_rx_pos == payloadSize) {
+                if (_working_states & STATUS_LOOP_MODE_FLAG) {
+                    // rewind to the payload recv status in loop mode
+                    _rx_pos = 0;
+                }
+                else {
+                    // reset the decoder
+                    _working_states = STATUS_WAIT_SYNC1;
+                }
+
+                IProtocolMessageListener* cachedLister = _listener.load(std::memory_order_acquire);
+
+                if (cachedLister) {
+                    cachedLister->onProtocolMessageDecoded(_decodingMessage);
+                }
+            }
+            continue;
+        }
+
         _u8 currentByte = *data;
         ++data;
 
@@ -202,31 +251,6 @@ void RPLidarProtocolCodec::onDecodeData(const void* buffer, size_t size)
                 _working_states = STATUS_WAIT_SYNC1;
             }
             break;
-        case STATUS_RECV_PAYLOAD:
-            _decodingMessage.getDataBuf()[_rx_pos++] = currentByte;
-
-            if ((size_t)_rx_pos == _decodingMessage.getPayloadSize()) {
-                if (_working_states & STATUS_LOOP_MODE_FLAG) {
-                    // rewind to the payload recv status in loop mode
-                    _rx_pos = 0;
-                }
-                else {
-                    // reset the decoder
-                    _working_states = STATUS_WAIT_SYNC1;
-                }
-
-                IProtocolMessageListener* cachedLister = _listener;
-
-                autolock.forceUnlock(); //unlock the oplock to prevent deadlock
-
-
-                if (cachedLister) {
-                    cachedLister->onProtocolMessageDecoded(_decodingMessage);
-                }
-
-                _op_locker.lock(); // relock it
-            }
-            break;
         }
 
     }
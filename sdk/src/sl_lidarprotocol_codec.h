@@ -41,6 +41,12 @@ namespace sl { namespace internal {
 class IProtocolMessageListener {
 public:
     virtual void onProtocolMessageDecoded(const ProtocolMessage&) = 0;
+
+    // Called in loop mode when a complete payload is available contiguously
+    // in the receive buffer. The payload is only valid during the call.
+    // Return true if the payload has been consumed, otherwise the codec
+    // copies it and reports it via onProtocolMessageDecoded() as usual.
+    virtual bool onLoopModePayloadDecoded(_u8 type, const _u8* payload, size_t size) { return false; }
 };
 
 
@@ -74,9 +80,15 @@ public:
 
 protected:
 
-    IProtocolMessageListener* _listener;
+    // only called from the decoder thread (or before it starts)
+    void _resetDecoder();
+
+    std::atomic<IProtocolMessageListener*> _listener;
+
+    // the decoding states below are owned by the decoder thread,
+    // other threads request a reset through _reset_requested
+    std::atomic<bool>        _reset_requested;
     ProtocolMessage          _decodingMessage;
-    rp::hal::Locker          _op_locker;
                             
     _u32                     _working_states;
     int                      _rx_pos;
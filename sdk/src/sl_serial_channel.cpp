@@ -40,10 +40,11 @@ namespace sl {
     class SerialPortChannel : public ISerialPortChannel
     {
     public:
-        SerialPortChannel(const std::string& device, int baudrate) :_rxtxSerial(rp::hal::serial_rxtx::CreateRxTx())
+        SerialPortChannel(const std::string& device, int baudrate, const SerialPortChannelOptions& options = SerialPortChannelOptions()) :_rxtxSerial(rp::hal::serial_rxtx::CreateRxTx())
         {
             _device = device;
             _baudrate = baudrate;
+            _options = options;
         }
 
         ~SerialPortChannel()
@@ -55,7 +56,8 @@ namespace sl {
         bool bind(const std::string& device, sl_s32 baudrate)
         {
             _closePending = false;
-            return _rxtxSerial->bind(device.c_str(), baudrate);
+            _rxtxSerial->setreadthreshold(_options.vmin, _options.vtime);
+            return _rxtxSerial->bind(device.c_str(), baudrate, _options.lowLatency ? rp::hal::serial_rxtx::FLAG_LOW_LATENCY : 0);
         }
 
         bool open()
@@ -104,6 +106,26 @@ namespace sl {
             return (_rxtxSerial->waitfordata(size, timeoutInMs, actualReady) == rp::hal::serial_rxtx::ANS_OK);
         }
 
+        sl_result waitAndRead(void* buffer, size_t size, size_t& received, sl_u32 timeoutInMs)
+        {
+            received = 0;
+
+            if (_closePending) return RESULT_OPERATION_TIMEOUT;
+
+            if (!_rxtxSerial->isOpened()) {
+                return RESULT_OPERATION_FAIL;
+            }
+
+            int ans = _rxtxSerial->waitandrecv((sl_u8*)buffer, _clampReadSize(size), timeoutInMs);
+            if (ans == rp::hal::serial_rxtx::ANS_DEV_ERR)
+                return RESULT_OPERATION_FAIL;
+            if (ans == rp::hal::serial_rxtx::ANS_TIMEOUT)
+                return RESULT_OPERATION_TIMEOUT;
+
+            received = (size_t)ans;
+            return RESULT_OK;
+        }
+
         int write(const void* data, size_t size)
         {
            return _rxtxSerial->senddata((const sl_u8 * )data, size);
@@ -112,7 +134,7 @@ namespace sl {
         int read(void* buffer, size_t size)
         {
             size_t lenRec = 0;
-            lenRec = _rxtxSerial->recvdata((sl_u8 *)buffer, size);
+            lenRec = _rxtxSerial->recvdata((sl_u8 *)buffer, _clampReadSize(size));
             return (int)lenRec;
         }
 
@@ -131,10 +153,16 @@ namespace sl {
         }
 
     private:
+        size_t _clampReadSize(size_t size) const
+        {
+            return (_options.readChunkSize && size > _options.readChunkSize) ? _options.readChunkSize : size;
+        }
+
         rp::hal::serial_rxtx  * _rxtxSerial;
         bool _closePending;
         std::string _device;
         int _baudrate;
+        SerialPortChannelOptions _options;
 
     };
 
@@ -143,4 +171,9 @@ namespace sl {
         return new  SerialPortChannel(device, baudrate);
     }
 
+    Result<IChannel*> createSerialPortChannel(const std::string& device, int baudrate, const SerialPortChannelOptions& options)
+    {
+        return new  SerialPortChannel(device, baudrate, options);
+    }
+
 }
\ No newline at end of file
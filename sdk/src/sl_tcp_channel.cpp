@@ -55,6 +55,7 @@ namespace sl {
         {
             if(!bind(_ip, _port))
                 return false;
+            _binded_socket->enableRxTimestamp(true);
             return IS_OK(_binded_socket->connect(_socket));
             
         }
@@ -106,6 +107,11 @@ namespace sl {
 
         void clearReadCache() {}
 
+        sl_u64 getLastReadTimestamp_uS()
+        {
+            return _binded_socket->getLastRxTimestamp_uS();
+        }
+
         void setStatus(_u32 flag){}
 
         int getChannelType() {
@@ -33,13 +33,33 @@
 #include "sl_lidar_driver.h"
 #include "hal/abs_rxtx.h"
 #include "hal/socket.h"
+#include <string.h>
+#include <vector>
+#include <atomic>
 
 
 namespace sl {
-	class UdpChannel : public IChannel
+	class UdpChannel : public IUdpChannel
 	{
 	public:
-		UdpChannel(const std::string& ip, int port) : _binded_socket(rp::net::DGramSocket::CreateSocket()) {
+        enum {
+            // datagrams sent by the device fit in an ethernet frame
+            RX_ARENA_SLOT_SIZE = 2048,
+            RX_ARENA_SLOT_COUNT = 32,
+        };
+
+		UdpChannel(const std::string& ip, int port)
+            : _binded_socket(rp::net::DGramSocket::CreateSocket())
+            , _rxArena(RX_ARENA_SLOT_SIZE * RX_ARENA_SLOT_COUNT)
+            , _pendingPos(0)
+            , _pendingCount(0)
+            , _pendingOffset(0)
+            , _lastReadTimestamp(0)
+            , _rcvBufSize(0)
+            , _dropCountSupported(false)
+            , _lastSocketDropCount(0)
+            , _kernelDropCount(0)
+        {
             _ip = ip;
             _port = port;
         }
@@ -52,15 +72,32 @@ namespace sl {
 
         bool open()
         {
+            if (!_binded_socket) {
+                _binded_socket = rp::net::DGramSocket::CreateSocket();
+                if (!_binded_socket)
+                    return false;
+                _lastSocketDropCount = 0;
+            }
+            _dropPending();
+
             if(!bind(_ip, _port))
                 return false;
+            if (_rcvBufSize)
+                _binded_socket->setReceiveBufferSize(_rcvBufSize);
+            _binded_socket->enableRxTimestamp(true);
+
+            _u32 dropCount;
+            _dropCountSupported = IS_OK(_binded_socket->getDropCount(dropCount));
             return SL_IS_OK(_binded_socket->setPairAddress(&_socket));         
         }
 
         void close()
         {
-            _binded_socket->dispose();
-            _binded_socket = NULL;
+            if (_binded_socket) {
+                _binded_socket->dispose();
+                _binded_socket = NULL;
+            }
+            _dropPending();
         }
         void flush()
         {
@@ -70,7 +107,9 @@ namespace sl {
         sl_result waitForDataExt(size_t& size_hint, sl_u32 timeoutInMs)
         {
             u_result ans;
-            size_hint = 0;
+            size_hint = _getPendingSize();
+            if (size_hint) return RESULT_OK;
+
             ans = _binded_socket->waitforData(timeoutInMs);
 
             switch (ans) {
@@ -86,10 +125,28 @@ namespace sl {
         {
             if (actualReady)
                 *actualReady = size;
+            if (_pendingCount) return true;
             return (_binded_socket->waitforData(timeoutInMs) == RESULT_OK);
 
         }
 
+        sl_result waitAndRead(void* buffer, size_t size, size_t& received, sl_u32 timeoutInMs)
+        {
+            received = 0;
+
+            if (!_pendingCount) {
+                u_result ans = _binded_socket->waitforData(timeoutInMs);
+                if (IS_FAIL(ans)) return ans;
+
+                ans = _receiveBatch();
+                if (ans == RESULT_OPERATION_TIMEOUT) return RESULT_OK;
+                if (IS_FAIL(ans)) return ans;
+            }
+
+            received = _copyPending(buffer, size);
+            return RESULT_OK;
+        }
+
         int write(const void* data, size_t size)
         {
             return _binded_socket->sendTo(nullptr, data, size);
@@ -99,13 +156,19 @@ namespace sl {
         {
             size_t actualGet;
 
+            if (_pendingCount) {
+                return (int)_copyPending(buffer, size);
+            }
+
             u_result ans = _binded_socket->recvFrom(buffer, size, actualGet);
+            _lastReadTimestamp = 0;
             if (IS_FAIL(ans)) return 0;
             return actualGet;
         
         }
 
         void clearReadCache() {
+            _dropPending();
             _binded_socket->clearRxCache();
         }
 
@@ -115,15 +178,114 @@ namespace sl {
             return CHANNEL_TYPE_UDP;
         }
 
+        sl_result setReceiveBufferSize(size_t size)
+        {
+            _rcvBufSize = size;
+            if (!_binded_socket) return RESULT_OK;
+            return _binded_socket->setReceiveBufferSize(size);
+        }
+
+        sl_u64 getLastReadTimestamp_uS()
+        {
+            return _lastReadTimestamp;
+        }
+
+        sl_result getKernelDropCount(sl_u64& count)
+        {
+            if (!_dropCountSupported) return RESULT_OPERATION_NOT_SUPPORT;
+            count = _kernelDropCount.load();
+            return RESULT_OK;
+        }
+
+    protected:
+        // fetch all the datagrams queued in the socket with a single call
+        u_result _receiveBatch()
+        {
+            size_t count = 0;
+            u_result ans = _binded_socket->recvBatch(&_rxArena[0], RX_ARENA_SLOT_SIZE, RX_ARENA_SLOT_COUNT, _rxLens, count, _rxTimestamps);
+            if (IS_FAIL(ans)) return ans;
+
+            _pendingPos = 0;
+            _pendingCount = count;
+            _pendingOffset = 0;
+
+            if (_dropCountSupported) {
+                // the kernel counter is 32bit and wraps around
+                _u32 dropCount;
+                if (IS_OK(_binded_socket->getDropCount(dropCount))) {
+                    _kernelDropCount += (_u32)(dropCount - _lastSocketDropCount);
+                    _lastSocketDropCount = dropCount;
+                }
+            }
+            return RESULT_OK;
+        }
+
+        size_t _copyPending(void* buffer, size_t size)
+        {
+            _u8* dest = reinterpret_cast<_u8*>(buffer);
+            size_t copied = 0;
+
+            while (_pendingCount && copied < size) {
+                const _u8* datagram = &_rxArena[_pendingPos * RX_ARENA_SLOT_SIZE];
+                size_t remain = _rxLens[_pendingPos] - _pendingOffset;
+                size_t chunk = remain < (size - copied) ? remain : (size - copied);
+
+                memcpy(dest + copied, datagram + _pendingOffset, chunk);
+                copied += chunk;
+                _pendingOffset += chunk;
+                _lastReadTimestamp = _rxTimestamps[_pendingPos];
+
+                if (_pendingOffset == _rxLens[_pendingPos]) {
+                    ++_pendingPos;
+                    --_pendingCount;
+                    _pendingOffset = 0;
+
+                    // a read carries a single timestamp, the datagrams received at another time
+                    // are left to the next read so that each of them keeps its own
+                    if (_pendingCount && _rxTimestamps[_pendingPos] != _lastReadTimestamp) break;
+                }
+            }
+            return copied;
+        }
+
+        size_t _getPendingSize() const
+        {
+            size_t total = 0;
+            for (size_t pos = _pendingPos; pos < _pendingPos + _pendingCount; ++pos) {
+                total += _rxLens[pos];
+            }
+            return total - _pendingOffset;
+        }
+
+        void _dropPending()
+        {
+            _pendingPos = 0;
+            _pendingCount = 0;
+            _pendingOffset = 0;
+        }
+
 	private:
 		rp::net::DGramSocket * _binded_socket;
 		rp::net::SocketAddress _socket;
         std::string _ip;
         int _port;
+
+        std::vector<_u8> _rxArena;
+        size_t _rxLens[RX_ARENA_SLOT_COUNT];
+        _u64 _rxTimestamps[RX_ARENA_SLOT_COUNT];
+        size_t _pendingPos;
+        size_t _pendingCount;
+        size_t _pendingOffset;
+        sl_u64 _lastReadTimestamp;
+
+        size_t _rcvBufSize;
+        bool _dropCountSupported;
+        _u32 _lastSocketDropCount;
+        std::atomic<sl_u64> _kernelDropCount;
 	};
 
     Result<IChannel*> createUdpChannel(const std::string& ip, int port)
     {
         return new  UdpChannel(ip, port);
     }
-}
\ No newline at end of file
+}